@@ -0,0 +1,15 @@
+class Vec:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+def step(p, k):
+    q = Vec(p.x * 0.5 + k, p.y * 0.25 - k)
+    pair = [q.x, q.y]
+    d = {"x": pair[0], "y": pair[1]}
+    return Vec(d["x"], d["y"] + 1.5)
+p = Vec(1.0, 2.0)
+total = 0.0
+for i in range(300000):
+    p = step(p, 0.001)
+    total = total + p.x + p.y
+print(total > 0)
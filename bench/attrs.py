@@ -0,0 +1,11 @@
+class Counter:
+    step = 1
+    def __init__(self):
+        self.total = 0
+        self.label = "counter"
+c = Counter()
+for i in range(200000):
+    c.total = c.total + c.step
+    c.label = "counter"
+print(c.total)
+print(c.label)
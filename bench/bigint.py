@@ -0,0 +1,17 @@
+f = 1
+for i in range(2000):
+    f = f * (i + 1)
+g = f * f
+print(g - f * f)
+h = 0
+for i in range(50000):
+    h = h * 31 + i
+    h = h & 18446744073709551615
+print(h)
+a = 0
+b = 1
+for i in range(3000):
+    c = a + b
+    a = b
+    b = c
+print(b ^ a)
@@ -0,0 +1,15 @@
+words = ["pear", "apple", "fig", "plum", "kiwi", "lime"]
+rows = [[1, 2, 3], [1, 2, 4], [0, 9], [1, 2, 3, 0]]
+less = 0
+same = 0
+for i in range(5000):
+    for w in words:
+        if w < "melon":
+            less = less + 1
+    for r in rows:
+        if r <= [1, 2, 3]:
+            same = same + 1
+    if i >= 4990.5:
+        less = less + 1
+print(less)
+print(same)
@@ -0,0 +1,9 @@
+class Point:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+i = 0
+while i != 20000:
+    p = Point(i, 1)
+    i = i + 1
+print(p.x)
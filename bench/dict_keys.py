@@ -0,0 +1,19 @@
+d = {}
+for i in range(5000):
+    d[i] = i * 2
+total = 0
+for i in range(5000):
+    total = total + d[i]
+print(total)
+names = {}
+key = "k"
+for i in range(1000):
+    key = key + "x"
+    names[key] = i
+hits = 0
+for i in range(3):
+    key = "k"
+    for j in range(1000):
+        key = key + "x"
+        hits = hits + names[key]
+print(hits)
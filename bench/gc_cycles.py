@@ -0,0 +1,25 @@
+class Node:
+    def __init__(self, value):
+        self.value = value
+        self.next = None
+        self.parent = None
+def make_ring(n):
+    head = Node(0)
+    prev = head
+    for i in range(n):
+        node = Node(i)
+        node.parent = head
+        prev.next = node
+        prev = node
+    prev.next = head
+    return head.value
+def make_graph():
+    a = {}
+    b = [a]
+    a["b"] = b
+    a["self"] = a
+    return 1
+total = 0
+for round in range(10000):
+    total = total + make_ring(50) + make_graph()
+print(total)
@@ -0,0 +1,16 @@
+class Item:
+    def __init__(self, key):
+        self.key = key
+        self.tags = [key]
+        self.owner = None
+def churn(k):
+    a = Item(k)
+    b = Item(k + 1)
+    a.owner = b
+    b.owner = a
+    return a.key + b.key
+heap = [Item(i) for i in range(60000)]
+total = 0
+for round in range(60000):
+    total = total + churn(round)
+print(total + heap[59999].key)
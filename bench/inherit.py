@@ -0,0 +1,16 @@
+class Base:
+    def value(self):
+        return 1
+class Mid(Base):
+    scale = 2
+class Leaf(Mid):
+    offset = 3
+class Mixin:
+    flag = 1
+class Deep(Leaf, Mixin):
+    depth = 4
+d = Deep()
+total = 0
+for i in range(100000):
+    total = total + Deep.value(d) + d.flag
+print(total)
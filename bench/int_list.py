@@ -0,0 +1,10 @@
+nums = [i * 3 for i in range(1000000)]
+halves = [x * 0.5 for x in nums]
+total = 0
+for x in nums:
+    total = total + x
+acc = 0.0
+for i in range(1000000):
+    acc = acc + halves[i]
+print(total)
+print(acc)
@@ -0,0 +1,9 @@
+data = [i for i in range(100000)]
+total = 0
+for round in range(200):
+    copy = data + []
+    same = data * 1
+    total = total + copy[round] + same[round]
+doubled = [x + x for x in data]
+print(total)
+print(doubled[99999])
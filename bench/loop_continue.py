@@ -0,0 +1,10 @@
+i = 0
+count = 0
+odd = False
+while i != 200000:
+    i = i + 1
+    odd = not odd
+    if odd:
+        continue
+    count = count + 1
+print(count)
@@ -0,0 +1,10 @@
+class Point:
+    __slots__ = ["x", "y"]
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+pts = [Point(i, 1) for i in range(100000)]
+total = 0
+for p in pts:
+    total = total + p.x + p.y
+print(total)
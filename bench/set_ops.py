@@ -0,0 +1,9 @@
+big = set(range(1000000))
+again = set(range(1000000))
+same = again - big
+print(same)
+small = {1, 2, 3, 999999, -1}
+print(small & big)
+print(small - big)
+print(small | {1000001})
+print({1, 2} ^ {2, 3})
@@ -0,0 +1,13 @@
+text = "the quick brown fox jumps over the lazy dog " * 5000
+count = 0
+for c in text:
+    if c == "o":
+        count = count + 1
+print(count)
+letters = [c for c in text]
+print(letters[4])
+hits = 0
+for i in range(100000):
+    if text[i] == " ":
+        hits = hits + 1
+print(hits)
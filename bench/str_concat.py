@@ -0,0 +1,14 @@
+piece = "0123456789" * 10
+s = ""
+for i in range(100000):
+    s = s + piece
+print(s[9999999])
+words = [piece for i in range(100000)]
+print(", ".join(words)[0])
+t = "x" * 300
+n = 0
+for i in range(100000):
+    t = t + "ab"
+    if t[i] == "x":
+        n = n + 1
+print(n)
@@ -0,0 +1,10 @@
+total = 0
+for round in range(20):
+    pairs = [(v for v in [i, i * 2]) for i in range(20000)]
+    for a, b in pairs:
+        total = total + a + b
+seen = {}
+for i in range(50000):
+    seen[(v for v in [i, i + 1])] = i
+print(total)
+print(seen[(v for v in [7, 8])])
@@ -4,6 +4,20 @@
 #include <vector>
 #include <memory>
 #include <variant>
+#include <cstdint>
+#include "bigint.hpp"
+
+class PyString;
+
+// Инлайн-кэш места обращения к атрибуту (obj.name): форма экземпляра, на
+// которой обращение сработало в прошлый раз, и слот атрибута в ней.
+// Заполняется при исполнении, см. Shape и PyInstance::slot_for в object.hpp.
+struct AttrCache {
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;   // в форме такого атрибута нет
+
+    uint32_t shape = 0;     // 0 — кэш пуст (у форм id начинаются с 1)
+    uint32_t slot = 0;
+};
 
 // Теги для конструктора PrimaryExpr (не меняем)
 struct CallTag {};
@@ -61,6 +75,20 @@ public:
     virtual void visit(class EnumerateStat &node) = 0;
 };
 
+// Где лежит значение имени — заполняет резолвер (см. resolver.hpp) до исполнения.
+//   Global — в таблице символов модуля (как и раньше, поиск по имени);
+//   Local  — в слоте slot плоского массива локальных переменных кадра;
+//   Cell   — в ячейке slot кадра (переменная, захваченная вложенной функцией,
+//            или свободная переменная, пришедшая из замыкания).
+enum class NameScope {
+    Global, Local, Cell
+};
+
+struct NameRef {
+    NameScope scope = NameScope::Global;
+    int slot = -1;
+};
+
 // Базовый узел AST
 class ASTNode {
 public:
@@ -117,6 +145,20 @@ public:
     std::unique_ptr<Statement> body;
     int line;  // номер строки, где стоит «def»
 
+    // --- Заполняет резолвер ---
+    NameRef nameRef;                        // куда записать саму функцию при объявлении
+    int nlocals = 0;                        // размер плоского массива локальных (параметры — первые слоты)
+    std::vector<std::string> localNames;    // имена локальных по слотам (для сообщений об ошибках)
+    // Ячейки кадра: сначала cellvars (свои локальные, захваченные вложенными функциями),
+    // затем freevars (захваченные из объемлющих функций, приходят из замыкания PyFunction).
+    std::vector<std::string> cellNames;
+    size_t ncellvars = 0;
+    std::vector<int> cellParamSlot;         // для cellvar-параметра — его слот в локальных, иначе -1
+    std::vector<int> freeSources;           // для каждой freevar — индекс ячейки в объемлющей функции
+
+    // --- Заполняет компилятор (только в режиме --stackless, см. bytecode.hpp) ---
+    std::shared_ptr<struct CodeObject> code;
+
     FuncDecl(
         const std::string &name,
         std::vector<std::string> posParams,
@@ -236,6 +278,8 @@ public:
     std::unique_ptr<BlockStat> body;
     int line;  // номер строки, где стоит «for»
 
+    std::vector<NameRef> iteratorRefs;  // привязки iterators (заполняет резолвер)
+
     ForStat(std::vector<std::string> iterators,
             std::unique_ptr<Expression> iterable,
             std::unique_ptr<BlockStat> body,
@@ -260,6 +304,10 @@ public:
     std::unique_ptr<Expression> expr;  // при return X
     int line;  // номер строки, где стоит «return»
 
+    // return f(...): вызов в хвостовой позиции (заполняет резолвер).
+    // С флагом --tail-calls кадр вызывающего переиспользуется для f.
+    class CallExpr *tailCall = nullptr;
+
     ReturnStat(int line)
         : expr(nullptr), line(line)
     {}
@@ -491,6 +539,8 @@ public:
     std::string name;
     int line;  // номер строки, где стоит идентификатор
 
+    NameRef ref;  // привязка имени (заполняет резолвер)
+
     IdExpr(const std::string &name, int line)
         : name(name), line(line)
     {}
@@ -505,14 +555,23 @@ public:
 class LiteralExpr : public Expression {
 public:
     // Возможные варианты литерала
-    using Value = std::variant<int, double, std::string, bool, std::monostate>;
+    // (целые, не влезающие в long long, хранятся как BigInt)
+    using Value = std::variant<long long, double, std::string, bool, std::monostate, BigInt>;
     Value value;
     int line;  // номер строки, где стоит литерал
 
-    LiteralExpr(int v, int line)
+    // Интернированная строка для строкового литерала (заполняет literal_value).
+    // Интернированные строки живут до конца программы, ссылку держать не нужно.
+    mutable PyString *internedStr = nullptr;
+
+    LiteralExpr(long long v, int line)
         : value(v), line(line)
     {}
 
+    LiteralExpr(BigInt v, int line)
+        : value(std::move(v)), line(line)
+    {}
+
     LiteralExpr(double v, int line)
         : value(v), line(line)
     {}
@@ -543,6 +602,10 @@ public:
     std::string name;
     int line;  // номер строки, где стоит точка
 
+    // Интернированное name (заполняется при первом исполнении узла)
+    PyString *internedName = nullptr;
+    AttrCache cache;
+
     AttributeExpr(std::unique_ptr<Expression> obj,
                   const std::string &name,
                   int line)
@@ -742,6 +805,9 @@ public:
     std::vector<std::unique_ptr<FuncDecl>> methods;
     int line;  // номер строки, где стоит «class»
 
+    NameRef nameRef;                // куда записать сам класс (заполняет резолвер)
+    std::vector<NameRef> baseRefs;  // привязки имён базовых классов
+
     ClassDecl(const std::string &name,
               std::vector<std::string> baseClasses,
               std::vector<std::unique_ptr<FieldDecl>> fields,
@@ -768,6 +834,8 @@ public:
     std::unique_ptr<Expression> iterableExpr;   // это то, по чему итерируемся (список/строка/и т.д.)
     int line;                                  // строка, где стоит '['
 
+    NameRef iterRef;  // привязка iterVar (заполняет резолвер)
+
     ListComp(std::unique_ptr<Expression> valueExpr,
              const std::string &iterVar,
              std::unique_ptr<Expression> iterableExpr,
@@ -795,6 +863,8 @@ public:
     std::unique_ptr<Expression> iterableExpr;   // объект, по которому итерируемся
     int line;                                  // строка, где стоит '{'
 
+    NameRef iterRef;  // привязка iterVar (заполняет резолвер)
+
     DictComp(std::unique_ptr<Expression> keyExpr,
              std::unique_ptr<Expression> valueExpr,
              const std::string &iterVar,
@@ -824,6 +894,8 @@ public:
     std::unique_ptr<Expression> iterableExpr;
     int line;  // строка, где стоит '('
 
+    NameRef iterRef;  // привязка iterVar (заполняет резолвер)
+
     TupleComp(std::unique_ptr<Expression> valueExpr,
               const std::string &iterVar,
               std::unique_ptr<Expression> iterableExpr,
@@ -847,6 +919,10 @@ public:
     std::unique_ptr<Expression> body;
     int line;  // строка, где встретилось слово 'lambda'
 
+    // FuncDecl лямбды: резолвер один раз переносит body в ReturnStat внутри него,
+    // так что каждое вычисление lambda создаёт PyFunction по одному и тому же узлу.
+    std::unique_ptr<FuncDecl> decl;
+
     LambdaExpr(std::vector<std::string> params,
                std::unique_ptr<Expression> body,
                int line)
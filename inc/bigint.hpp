@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// BigInt — целое произвольной длины для PyInt.
+//
+// PyInt хранит значение в int64_t, пока оно туда помещается; BigInt нужен
+// только когда арифметика переполняет машинное слово (см. PyInt в object.hpp).
+//
+// Представление: знак + модуль в виде «цифр» по 32 бита (limbs), младшие
+// первыми, без ведущих нулей. Ноль — пустой вектор и neg == false, поэтому
+// у каждого числа ровно одно представление и == сравнивает поля напрямую.
+//
+// Умножение — в столбик, а для длинных чисел (от KARATSUBA_CUTOFF цифр) —
+// Карацуба. Перевод в десятичную строку отщепляет по 9 цифр за проход
+// (деление на 10^9 одной машинной операцией на цифру).
+// Побитовые |, &, ^ — как в Python: отрицательные числа ведут себя как
+// бесконечное дополнение до двух.
+// -----------------------------------------------------------------------------
+class BigInt {
+public:
+    BigInt() = default;
+    explicit BigInt(int64_t v);
+
+    // Десятичная запись: необязательный '-' и цифры
+    static BigInt from_string(std::string_view text);
+    // Точное значение целочисленного конечного double
+    static BigInt from_double(double whole);
+
+    bool is_zero() const { return mag.empty(); }
+    bool is_negative() const { return neg; }
+
+    // Помещается ли в int64_t (и само значение, если да)
+    bool fits_int64() const;
+    int64_t to_int64() const;
+    // Младшие 64 бита в дополнительном коде (для x & маска)
+    uint64_t low_bits() const;
+
+    double to_double() const;
+    // Как std::frexp: значение ≈ m * 2^exp, |m| в [0.5, 1). В отличие от
+    // to_double не переполняется — для деления огромных чисел
+    double to_frexp(long &exp) const;
+    std::string to_string() const;
+
+    BigInt operator-() const;
+
+    friend BigInt operator+(const BigInt &a, const BigInt &b);
+    friend BigInt operator-(const BigInt &a, const BigInt &b);
+    friend BigInt operator*(const BigInt &a, const BigInt &b);
+    friend BigInt operator|(const BigInt &a, const BigInt &b);
+    friend BigInt operator&(const BigInt &a, const BigInt &b);
+    friend BigInt operator^(const BigInt &a, const BigInt &b);
+
+    // <0, 0, >0 — как a <=> b
+    friend int compare(const BigInt &a, const BigInt &b);
+    bool operator==(const BigInt &other) const = default;
+
+    // Число цифр (по 32 бита), начиная с которого умножение идёт по Карацубе
+    static constexpr std::size_t KARATSUBA_CUTOFF = 48;
+
+private:
+    using Mag = std::vector<uint32_t>;
+
+    bool neg = false;
+    Mag mag;
+
+    BigInt(bool negative, Mag magnitude);
+
+    static void trim(Mag &m);
+    static int cmp_mag(const Mag &a, const Mag &b);
+    static Mag add_mag(const Mag &a, const Mag &b);
+    static Mag sub_mag(const Mag &a, const Mag &b);     // |a| >= |b|
+    static Mag mul_mag(const Mag &a, const Mag &b);
+    static Mag mul_school(const Mag &a, const Mag &b);
+    static Mag mul_karatsuba(const Mag &a, const Mag &b);
+    static void add_shifted(Mag &acc, const Mag &x, std::size_t shift);
+    static void sub_in_place(Mag &acc, const Mag &x);   // acc >= x
+
+    template <class Op>
+    static BigInt bitwise(const BigInt &a, const BigInt &b, Op op);
+};
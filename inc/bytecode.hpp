@@ -0,0 +1,106 @@
+#pragma once
+
+#include "object.hpp"
+#include "ast.hpp"
+#include "value.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Байткод для «stackless»-режима (--stackless).
+// Компилятор (compiler.hpp) переводит AST в последовательность инструкций
+// стековой машины, а Executor::run_code исполняет их в одном цикле:
+// вызов пользовательской функции не уходит в рекурсию C++, а кладёт кадр
+// в Executor::frames (в куче), поэтому глубина рекурсии Python-кода
+// ограничена только --recursion-limit, а не размером нативного стека.
+
+enum class OpCode : uint8_t {
+    LOAD_CONST,         // arg — индекс в consts
+    LOAD_LOCAL,         // arg — слот локальной переменной
+    STORE_LOCAL,
+    LOAD_CELL,          // arg — индекс ячейки кадра
+    STORE_CELL,
+    LOAD_GLOBAL,        // arg — индекс имени в names
+    STORE_GLOBAL,       // arg — индекс имени, arg2 — SymbolType
+    POP_TOP,
+
+    BINARY,             // arg — BinOp; у BinOp::Unsupported arg2 — индекс текста оператора в names
+    UNARY,              // arg — UnOp
+    LOAD_INDEX,         // base, index → base[index]
+    STORE_INDEX,        // value, base, index → base[index] = value
+    LOAD_ATTR,          // arg — индекс имени атрибута, arg2 — индекс в attr_caches
+    STORE_ATTR,         // value, obj → obj.name = value (arg, arg2 — как у LOAD_ATTR)
+
+    BUILD_LIST,         // arg — число элементов
+    BUILD_DICT,         // arg — число пар
+    BUILD_SET,          // arg — число элементов
+    LIST_APPEND,        // добавить вершину в список под итератором (генераторы списков)
+    LIST_TO_TUPLE,      // список на вершине → кортеж из его элементов (генераторы кортежей)
+    DICT_SET,           // ключ, значение → в словарь под итератором (генераторы словарей)
+
+    JUMP,               // arg — адрес перехода
+    POP_JUMP_IF_FALSE,
+    POP_JUMP_IF_TRUE,
+    GET_ITER,           // arg = 1 — итерировать по копии (генераторы), 0 — по живому списку (for)
+    FOR_ITER,           // следующий элемент или (если кончились) снять итератор и перейти на arg
+    UNPACK,             // arg — сколько имён распаковываем в for
+
+    CALL,               // arg — число аргументов; под ними — вызываемый объект
+    TAIL_CALL,          // как CALL, но кадр пользовательской функции встаёт на место текущего
+    RETURN_VALUE,
+    MAKE_FUNCTION,      // arg — индекс в functions, arg2 — число default-значений на стеке
+    MAKE_CLASS,         // arg — индекс в classes; класс остаётся на стеке
+    SET_CLASS_ATTR,     // arg — индекс имени: value → в словарь класса под ним (класс не снимаем)
+    END_CLASS,          // тело класса исполнено: PyClass::seal_layout, класс снимается со стека
+
+    PRINT,              // arg = 1 — печатать вершину, 0 — пустую строку
+    ASSERT_FAIL,        // arg = 1 — на стеке сообщение
+    EXIT                // arg = 1 — на стеке код/объект
+};
+
+struct Instr {
+    OpCode op;
+    int arg = 0;
+    int arg2 = 0;
+    int line = 0;       // строка исходника — для сообщений об ошибках
+};
+
+// Внутренний итератор цикла for и генераторов: лежит на стеке значений
+// между GET_ITER и FOR_ITER и в пользовательский код не попадает.
+class PyIterator : public Object {
+public:
+    Ref<PyList> list;       // for по списку — читаем «живой» список, как обходчик AST
+    Ref<ListBuffer> items;  // снимок буфера списка (генераторы) или символы строки
+    Ref<PyTuple> tuple;     // кортеж неизменяем — читаем его самого
+    size_t pos = 0;
+
+    // Следующий элемент или пустое Value, если элементы кончились.
+    // Неупакованные элементы списка объектов не создают (см. list_item).
+    Value next() {
+        if (tuple) {
+            return pos < tuple->size() ? Value(tuple->item(pos++)) : Value();
+        }
+        const ListBuffer &elems = list ? *list->buffer() : *items;
+        return pos < elems.size() ? list_item(elems, pos++) : Value();
+    }
+
+    std::type_index type() const override {
+        return typeid(PyIterator);
+    }
+    std::string repr() const override {
+        return "<iterator>";
+    }
+};
+
+// Скомпилированное тело модуля или функции
+struct CodeObject {
+    std::string name;
+    std::vector<Instr> code;
+    std::vector<Value> consts;              // литералы (скаляры хранятся без упаковки)
+    std::vector<std::string> names;         // глобальные имена, атрибуты, операторы
+    std::vector<Ref<PyString>> name_objs;   // те же имена, интернированные (для атрибутов)
+    mutable std::vector<AttrCache> attr_caches; // инлайн-кэши LOAD_ATTR/STORE_ATTR (меняются при исполнении)
+    std::vector<FuncDecl*> functions;       // def и lambda, создаваемые в этом коде
+    std::vector<ClassDecl*> classes;        // классы, объявленные в этом коде
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ast.hpp"
+#include "bytecode.hpp"
+#include "error_reporter.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Компилятор AST → байткод (для режима --stackless, см. bytecode.hpp).
+// Запускается после резолвера: имена уже разложены по локальным слотам,
+// ячейкам и глобальной таблице, так что LOAD/STORE выбираются по NameRef.
+//
+// Тело каждой функции (и лямбды) компилируется один раз в собственный
+// CodeObject и сохраняется в FuncDecl::code; модуль возвращается из compile().
+// break/continue превращаются в переходы, а return вне функции и break/continue
+// вне цикла — ошибки компиляции с теми же сообщениями, что у обходчика AST.
+class Compiler : public ASTVisitor {
+public:
+    // tailCalls — компилировать return f(...) в TAIL_CALL (флаг --tail-calls)
+    explicit Compiler(ErrorReporter &reporter, bool tailCalls = false)
+        : reporter(reporter), tailCalls(tailCalls) {}
+
+    std::shared_ptr<CodeObject> compile(TransUnit &unit);
+
+    void visit(TransUnit  &node) override;
+    void visit(FuncDecl   &node) override;
+    void visit(ClassDecl  &node) override;
+    void visit(BlockStat  &node) override;
+    void visit(ExprStat   &node) override;
+    void visit(AssignStat &node) override;
+    void visit(IdExpr     &node) override;
+    void visit(LiteralExpr&node) override;
+    void visit(BinaryExpr &node) override;
+    void visit(UnaryExpr  &node) override;
+    void visit(PrimaryExpr  &node) override;
+    void visit(CallExpr   &node) override;
+    void visit(IndexExpr  &node) override;
+    void visit(AttributeExpr &node) override;
+    void visit(ListExpr   &node) override;
+    void visit(DictExpr   &node) override;
+    void visit(SetExpr    &node) override;
+    void visit(TernaryExpr&node) override;
+
+    void visit(CondStat    &node) override;
+    void visit(WhileStat   &node) override;
+    void visit(ForStat     &node) override;
+    void visit(ReturnStat  &node) override;
+    void visit(BreakStat   &node) override;
+    void visit(ContinueStat&node) override;
+    void visit(PassStat    &node) override;
+    void visit(AssertStat  &node) override;
+    void visit(ExitStat    &node) override;
+    void visit(PrintStat   &node) override;
+
+    void visit(ListComp &node) override;
+    void visit(DictComp &node) override;
+    void visit(TupleComp &node) override;
+
+    void visit(LambdaExpr &node) override;
+
+    void visit(class LenStat &node) override;
+    void visit(class DirStat &node) override;
+    void visit(class EnumerateStat &node) override;
+
+private:
+    // Открытый цикл: куда прыгает continue и какие переходы break нужно
+    // дописать, когда станет известен конец цикла.
+    struct Loop {
+        bool isFor;                         // на стеке лежит итератор — break должен его снять
+        size_t continueTarget;
+        std::vector<size_t> breakJumps;
+    };
+
+    ErrorReporter &reporter;
+    bool tailCalls;
+    CodeObject *code = nullptr;             // куда сейчас пишем инструкции
+    bool inFunction = false;
+    std::vector<Loop> loops;                // циклы текущей функции (или модуля)
+
+    size_t emit(OpCode op, int arg, int arg2, int line);
+    size_t emit(OpCode op, int arg, int line) { return emit(op, arg, 0, line); }
+    void patch(size_t at, size_t target);
+    size_t here() const { return code->code.size(); }
+
+    int add_const(Value value);
+    int add_name(const std::string &name);
+    int add_attr_cache();
+
+    void load_name(const NameRef &ref, const std::string &name, int line);
+    void store_name(const NameRef &ref, const std::string &name, int line,
+                    SymbolType type = SymbolType::Variable);
+
+    // Тело функции → FuncDecl::code; затем MAKE_FUNCTION в текущем коде
+    void function(FuncDecl &node, int line);
+
+    // Общая часть генераторов: итерация по iterable с привязкой iterVar;
+    // body кладёт в контейнер под итератором очередной элемент.
+    template <class Body>
+    void comprehension(Expression &iterable, const NameRef &ref, const std::string &var,
+                       int line, Body body);
+
+    void accept(ASTNode *node) {
+        if (node) node->accept(*this);
+    }
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ref.hpp"
+
+class Object;
+
+// Чем закончилось выполнение инструкции.
+// Раньше return/break/continue бросали C++-исключения (ReturnException и т.д.),
+// а раскрутка стека стоит микросекунды на каждый return или continue.
+// Теперь каждая инструкция оставляет «запись о завершении», а блоки, циклы
+// и вызовы функций явно проверяют её и пробрасывают дальше.
+enum class Flow {
+    Normal,     // инструкция выполнилась, идём к следующей
+    Return,     // return <value> — выходим до ближайшего вызова функции
+    Break,      // break — выходим до ближайшего цикла
+    Continue    // continue — переходим к следующей итерации ближайшего цикла
+};
+
+struct Completion {
+    Flow flow = Flow::Normal;
+    Ref<Object> value;  // значение return (для остальных случаев пусто)
+
+    bool is_normal() const {
+        return flow == Flow::Normal;
+    }
+};
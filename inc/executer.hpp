@@ -5,7 +5,9 @@
 #include "scope.hpp"
 #include "error_reporter.hpp"
 #include "type_registry.hpp"
-#include "executer_excepts.hpp"
+#include "completion.hpp"
+#include "bytecode.hpp"
+#include "value.hpp"
 
 #include <memory>
 #include <string>
@@ -13,40 +15,97 @@
 #include <stdexcept>
 
 
+// Кадр вызова пользовательской функции. Кадры лежат в Executor::frames —
+// одном стеке на весь интерпретатор, поэтому вызов не создаёт новый Executor.
+// Локальные переменные кадра — плоский участок Executor::local_slots
+// начиная с base (номера слотов раздаёт резолвер), а захваченные
+// переменные — в cells: сначала cellvars функции, затем её замыкание.
+//
+// В режиме --stackless кадр дополнительно хранит, где продолжить вызывающий
+// код после RETURN_VALUE (returnCode/returnPc), и какую часть value_stack
+// занимает сам вызов — стек C++ при вызове при этом не растёт.
+struct Frame {
+    PyFunction *function = nullptr;             // какую функцию исполняем
+    size_t base = 0;                            // начало локальных в local_slots
+    std::vector<std::shared_ptr<Cell>> cells;   // ячейки (пусто, если замыканий нет)
+    int callLine = 0;                           // строка вызова (0, если неизвестна)
+
+    const CodeObject *returnCode = nullptr;     // код вызывающего (только для run_code)
+    size_t returnPc = 0;                        // адрес инструкции после CALL
+    size_t stackBase = 0;                       // высота value_stack до вызова
+    ObjectPtr initInstance;       // экземпляр, если кадр — __init__ из Class(...)
+    ObjectPtr callee;             // держит функцию живой, пока исполняется кадр
+};
+
+// Настройки исполнения (флаги командной строки, см. main.cpp)
+struct ExecutorOptions {
+    bool stackless = false;         // --stackless: компилировать в байткод и исполнять run_code
+    int recursionLimit = 1000;      // --recursion-limit N: максимальная глубина вызовов
+    bool tailCalls = false;         // --tail-calls: return f(...) переиспользует кадр вызывающего
+};
+
+// Отложенный хвостовой вызов (см. visit(ReturnStat) и call_function)
+struct TailCall {
+    Ref<PyFunction> function;
+    std::vector<ObjectPtr> args;
+    int line = 0;
+};
+
 class Executor : public ASTVisitor {
 public:
 
     Scope scopes;                  // наша таблица символов / областей видимости
 
-    Executor();
+    explicit Executor(ExecutorOptions opts = {});
 
     
     void execute(TransUnit &unit);
 
     // вычислить одно выражение 
-    std::shared_ptr<Object> evaluate(Expression &expr);
+    ObjectPtr evaluate(Expression &expr);
+
+    void push_value(ObjectPtr val) {
+        value_stack.emplace_back(std::move(val));
+    }
+
+    // Снять значение как объект (скаляр при этом упаковывается, см. value.hpp)
+    ObjectPtr pop_value() {
+        return pop().object();
+    }
+
+    ObjectPtr peek_value() const {
+        if (value_stack.empty()) {
+            throw RuntimeError("peek_value: empty stack");
+        }
 
-    void push_value(std::shared_ptr<Object> val) {
+        return value_stack.back().object();
+    }
+
+    // То же без упаковки — для арифметики, условий и локальных переменных
+    void push(Value val) {
         value_stack.push_back(std::move(val));
     }
 
-    std::shared_ptr<Object> pop_value() {
+    Value pop() {
         if (value_stack.empty()) {
             throw RuntimeError("pop_value : empty stack\n");
         }
 
-        auto tmp = value_stack.back();
+        Value tmp = std::move(value_stack.back());
         value_stack.pop_back();
         return tmp;
     }
 
-    std::shared_ptr<Object> peek_value() const {
-        if (value_stack.empty()) {
-            throw RuntimeError("peek_value: empty stack");
-        }
+    // Вызвать пользовательскую функцию: проверить число аргументов, положить кадр,
+    // привязать параметры в новом скоупе поверх лексического окружения функции,
+    // выполнить тело и вернуть результат. line — строка вызова для сообщений об ошибках.
+    ObjectPtr call_function(PyFunction &fn,
+                                          const std::vector<ObjectPtr> &args,
+                                          int line = 0);
 
-        return value_stack.back();
-    }
+    // Выполнить тело пользовательской функции (параметры уже привязаны
+    // в текущем скоупе) и вернуть значение return — или None, если return не было.
+    ObjectPtr run_function_body(FuncDecl *decl);
 
 
     void visit(TransUnit  &node) override;
@@ -90,8 +149,69 @@ public:
     void visit(class EnumerateStat &node) override;
 
 private:
-    
+
+    ExecutorOptions options;
     ErrorReporter reporter;        // для накопления и печати ошибок
 
-    std::vector<std::shared_ptr<Object>> value_stack;
+    // Стек вычислений (общий для обходчика AST и байткода). Скаляры лежат
+    // в Value без объектов — см. value.hpp.
+    std::vector<Value> value_stack;
+
+    // Чем закончилась последняя инструкция: Normal, либо return/break/continue,
+    // который ещё «летит» наверх. BlockStat прекращает выполнение при любом
+    // не-Normal, циклы поглощают Break/Continue, вызов функции — Return.
+    Completion completion;
+
+    // return f(...), который ReturnStat оставил для call_function (--tail-calls)
+    TailCall tailCall;
+
+    // Стек кадров вызовов пользовательских функций
+    std::vector<Frame> frames;
+
+    // Локальные переменные всех активных кадров подряд (см. Frame::base)
+    std::vector<Value> local_slots;
+
+    // Чтение/запись имени по привязке резолвера: локальный слот, ячейка
+    // или (для Global) таблица символов модуля.
+    Value load_name(const NameRef &ref, const std::string &name, int line);
+    void store_name(const NameRef &ref, const std::string &name,
+                    Value value,
+                    SymbolType type = SymbolType::Variable, ASTNode *decl = nullptr);
+
+    // Положить кадр вызова fn (проверка числа аргументов и глубины рекурсии,
+    // привязка параметров, ячейки) и снять его — общие для обоих движков.
+    // args — nargs значений подряд (байткод передаёт их прямо со стека).
+    void push_frame(PyFunction &fn, const Value *args, size_t nargs, int line);
+    void pop_frame();
+
+    // Хвостовой вызов: только что положенный кадр занимает место предыдущего
+    // (локальные переезжают вниз, адрес возврата наследуется).
+    void replace_caller_frame();
+
+    // Вызвать любой объект: встроенную или пользовательскую функцию, класс, ...
+    ObjectPtr call_object(const ObjectPtr &callee,
+                                        const std::vector<ObjectPtr> &args,
+                                        int line);
+
+    // Создать PyFunction по FuncDecl, захватив ячейки его свободных переменных
+    // из текущего кадра.
+    Ref<PyFunction> make_function(FuncDecl &decl, std::vector<ObjectPtr> defaults);
+
+    // Создать пустой класс по ClassDecl (найти базовый класс) и записать его
+    // под именем класса; поля и методы в его словарь кладёт вызывающий.
+    Ref<PyClass> make_class(ClassDecl &node);
+
+    // Исполнить байткод (--stackless). Вызовы пользовательских функций кладут
+    // кадр в frames и продолжают тот же цикл, без рекурсии C++. Возвращает
+    // значение RETURN_VALUE кадра глубины stopDepth (для модуля, stopDepth == 0, —
+    // пустое Value по достижении конца кода); кадр stopDepth снимает вызывающий.
+    Value run_code(const CodeObject &code, size_t stopDepth);
+
+    // Одна итерация тела цикла; false — цикл пора прекращать (break/return).
+    bool run_loop_body(BlockStat &body);
+
+    // Глубина вложенности циклов и функций — чтобы break/continue/return
+    // вне своего контекста давали SyntaxError, а не «повисали» в completion.
+    int loop_depth = 0;
+    int func_depth = 0;
 };
@@ -2,13 +2,22 @@
 
 #include "ast.hpp"        // для FuncDecl и т.п., если нужно
 #include "symbol_table.hpp"
-#include "executer_excepts.hpp"
+#include "ref.hpp"
+#include "bigint.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <sstream>
 #include <memory>
+#include <new>
 #include <vector>
 #include <typeindex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <stdexcept>    
 
 // -----------------------------------------------------------------------------
@@ -22,6 +31,7 @@ class PyBool;
 class PyFloat;
 class PyString;
 class PyList;
+class PyTuple;
 class PyDict;
 class PySet;
 class PyBuiltinFunction;
@@ -29,21 +39,64 @@ class PyFunction;
 class PyNone;
 class PyInstance;
 class PyClass;
+class Executor;
 
 // -----------------------------------------------------------------------------
 // Object и RuntimeError
 // -----------------------------------------------------------------------------
 class Object;
-using ObjectPtr = std::shared_ptr<Object>;
+using ObjectPtr = Ref<Object>;
 
 struct RuntimeError : std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
-class Object {
+// Вид объекта. Хранится одним байтом в каждом Object, чтобы узнавать тип
+// сравнением или switch'ем вместо цепочки dynamic_cast (RTTI-обход на каждую
+// проверку). Встроенные классы задают свой вид в конструкторе (T::KIND).
+enum class Kind : uint8_t {
+    None, Bool, Int, Float, String, List, Tuple, Dict, Set,
+    BuiltinFunction, Function, Instance, Class,
+    Other       // служебные объекты (например, итератор байткода)
+};
+
+// Имя типа вида kind для сообщений об ошибках
+inline const char *kind_name(Kind kind) {
+    switch (kind) {
+        case Kind::Int:             return "int";
+        case Kind::Float:           return "float";
+        case Kind::Bool:            return "bool";
+        case Kind::String:          return "str";
+        case Kind::List:            return "list";
+        case Kind::Tuple:           return "tuple";
+        case Kind::Dict:            return "dict";
+        case Kind::Set:             return "set";
+        case Kind::None:            return "NoneType";
+        case Kind::BuiltinFunction: return "builtin_function_or_method";
+        case Kind::Function:        return "function";
+        default:                    return "object";
+    }
+}
+
+// a < b для несравнимых типов. Несёт типы той пары, на которой сравнение
+// споткнулось: у списков и кортежей это типы элементов, а не самих списков.
+struct UnorderableError : RuntimeError {
+    Kind left, right;
+    UnorderableError(Kind a, Kind b)
+        : RuntimeError(std::string("unorderable types: ") + kind_name(a) + " < " + kind_name(b)),
+          left(a), right(b) {}
+};
+
+class Object : public RefCounted {
 public:
+    // Сколько объектов создано за время работы (печатается по --stats)
+    static inline std::size_t allocated = 0;
+
+    explicit Object(Kind kind = Kind::Other) : objectKind(kind) { ++allocated; }
     virtual ~Object() = default;
 
+    Kind kind() const { return objectKind; }
+
     virtual ObjectPtr __add__(ObjectPtr right) {
         throw RuntimeError("unsupported operand types for +");
     }
@@ -56,6 +109,15 @@ public:
     virtual ObjectPtr __div__(ObjectPtr right) {
         throw RuntimeError("unsupported operand types for /");
     }
+    virtual ObjectPtr __or__(ObjectPtr right) {
+        throw RuntimeError("unsupported operand types for |");
+    }
+    virtual ObjectPtr __and__(ObjectPtr right) {
+        throw RuntimeError("unsupported operand types for &");
+    }
+    virtual ObjectPtr __xor__(ObjectPtr right) {
+        throw RuntimeError("unsupported operand types for ^");
+    }
 
     virtual ObjectPtr __getitem__(ObjectPtr idx) {
         throw RuntimeError("object is not subscriptable");
@@ -64,30 +126,253 @@ public:
         throw RuntimeError("object does not support item assignment");
     }
 
-    virtual void __setattr__(const std::string &name, ObjectPtr value) {
-        throw RuntimeError("object has no attribute '" + name + "'");
-    }
+    // Имена атрибутов — интернированные строки (py_intern): тогда поиск в словаре
+    // атрибутов сравнивает ключи по адресу, а хеш уже посчитан.
+    virtual void __setattr__(const Ref<PyString> &name, ObjectPtr value);
     virtual bool __contains__(ObjectPtr item) {
         throw RuntimeError("object is not iterable");
     }
-    virtual ObjectPtr __getattr__(const std::string &name) {
-        throw RuntimeError("object has no attribute '" + name + "'");
-    }
+    virtual ObjectPtr __getattr__(const Ref<PyString> &name);
 
     virtual ObjectPtr __call__(const std::vector<ObjectPtr> & args) {
         throw RuntimeError("object is not callable");
     }
 
+    // Хеш и равенство ключей словаря. По умолчанию — через repr() (так ключи
+    // сравнивались всегда); скаляры и строки считают их без форматирования,
+    // экземпляры и классы сравниваются по адресу. Равные объекты обязаны
+    // иметь равные хеши.
+    virtual std::size_t __hash__() const {
+        return std::hash<std::string>{}(repr());
+    }
+    virtual bool __eq__(const Object &other) const {
+        return repr() == other.repr();
+    }
+    // Порядок для <, <=, >, >=. Числа сравниваются численно, строки и списки —
+    // лексикографически; остальные пары типов несравнимы (TypeError, как в Python).
+    virtual bool __lt__(const Object &other) const {
+        throw UnorderableError(kind(), other.kind());
+    }
+
     virtual std::type_index type() const = 0;
     virtual std::string repr() const = 0;
+
+    // Объект может хранить ссылки на другие объекты (см. GcObject)
+    bool gc_container() const { return gcContainer; }
+    // Контейнер сейчас под надзором сборщика циклов (записан в GcHeap)
+    bool gc_tracked() const { return gcTracked; }
+
+private:
+    Kind objectKind;
+    bool gcContainer = false;   // оба флага лежат в выравнивании после objectKind
+    bool gcTracked = false;
+
+    friend class GcObject;
+    friend class GcHeap;
+};
+
+// Приведение по виду: T*, если obj — объект вида T::KIND, иначе nullptr.
+// Замена dynamic_ref_cast для встроенных классов (у них нет наследников).
+template <class T>
+T *kind_cast(const ObjectPtr &obj) {
+    return obj && obj->kind() == T::KIND ? static_cast<T*>(obj.get()) : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// GcObject и GcHeap: сборка циклов ссылок
+// -----------------------------------------------------------------------------
+// Подсчёт ссылок не освобождает циклы: экземпляры, ссылающиеся друг на друга,
+// список, лежащий в самом себе, класс, в словаре которого есть его экземпляр.
+// Поэтому каждый объект, способный хранить ссылки на другие объекты
+// (список, кортеж, словарь, множество, экземпляр, класс, функция), — GcObject:
+// он записан в реестр GcHeap и умеет перечислить свои ссылки (gc_traverse)
+// и отпустить их (gc_clear).
+//
+// Сборка — пробное удаление, как в CPython (GcHeap::collect, src/gc.cpp):
+// из счётчика ссылок каждого контейнера вычитаются ссылки из других
+// контейнеров; у кого что-то осталось — на того ссылаются извне (стек,
+// переменные, таблицы символов), он и всё достижимое из него живы.
+// Остальные — мусор, который держится только друг за друга: им делается
+// gc_clear, циклы рвутся, и объекты освобождаются обычным подсчётом ссылок.
+//
+// gc_traverse обязан перечислять только ссылки, которыми объект владеет
+// единолично (лишняя — и живой объект сочтут мусором); пропущенная ссылка
+// безопасна — она лишь считается внешней.
+//
+// Поколения. Большинство контейнеров умирает молодыми (временные списки,
+// пары, словари аргументов), а пережившие одну сборку обычно живут долго.
+// Поэтому новый контейнер попадает в молодое поколение, и обычная сборка
+// обходит только его; ссылки из старого поколения при этом считаются
+// внешними. Пережившие сборку переходят в старое поколение, которое целиком
+// обходится редко — когда оно удвоилось с прошлой полной сборки, так что
+// повторные обходы живой кучи в сумме линейны по её размеру. Мусорный цикл,
+// успевший состариться, доживает до ближайшей полной сборки.
+//
+// Барьер записи. Список, кортеж, словарь или множество, в которых лежат
+// только атомарные значения (числа, строки, None), в цикле участвовать не
+// могут, и сборщик их не видит вовсе: такой контейнер не записан в GcHeap.
+// Записывается он в момент, когда в него кладут другой контейнер
+// (gc_write_barrier — в __setitem__, append, add), и с тех пор остаётся
+// под надзором. Экземпляры, классы и функции ссылаются на класс, словарь
+// или область видимости с самого создания и записываются сразу.
+class GcObject : public Object {
+public:
+    using Visit = void (*)(Object *child, void *ctx);
+
+    // visit(child, ctx) для каждой ссылки объекта на другой объект
+    virtual void gc_traverse(Visit visit, void *ctx) const = 0;
+    // Отпустить ссылки; вызывается только у недостижимых объектов
+    virtual void gc_clear() = 0;
+
+    // Барьер записи: объект начал хранить ссылку на stored
+    void gc_write_barrier(const Object &stored) {
+        if (!gc_tracked() && stored.gc_container()) {
+            gc_track();
+        }
+    }
+
+protected:
+    // tracked == false — контейнер атомарных значений (см. барьер записи выше)
+    explicit GcObject(Kind kind, bool tracked = true);
+    ~GcObject() override;
+
+    void gc_track();
+
+    static void gc_visit(const ObjectPtr &child, Visit visit, void *ctx) {
+        if (child) {
+            visit(child.get(), ctx);
+        }
+    }
+
+private:
+    uint32_t gcIndex = 0;       // место в GcHeap::objects
+    uint32_t gcRefs = 0;        // рабочий счётчик во время сборки
+
+    friend class GcHeap;
+};
+
+// Сколько новых контейнеров запускает сборку молодого поколения
+#ifndef PY_GC_THRESHOLD
+#define PY_GC_THRESHOLD 700
+#endif
+
+// 0 — без поколений: каждая сборка обходит все контейнеры, а порог растёт
+// вместе с их числом (для сравнения, make CXXFLAGS+=-DPY_GC_GENERATIONAL=0)
+#ifndef PY_GC_GENERATIONAL
+#define PY_GC_GENERATIONAL 1
+#endif
+
+// Реестр контейнеров и запуск сборки. Сборка идёт только в безопасных
+// точках интерпретатора (начало итерации цикла, вызов функции), где все
+// живые объекты удерживаются через Ref, — не посреди создания объекта.
+struct GcStats {
+    std::size_t youngCollections = 0;   // сборки молодого поколения
+    std::size_t fullCollections = 0;    // полные сборки
+    std::size_t freed = 0;              // сколько контейнеров они освободили
+    std::size_t promoted = 0;           // сколько перешло в старое поколение
+    double pauseMs = 0;                 // суммарное время сборок
+    double maxPauseMs = 0;              // самая долгая сборка
+};
+
+class GcHeap {
+public:
+    // objects[0, oldCount) — старое поколение, objects[oldCount, size) — молодое
+    static void track(GcObject *obj) {
+        obj->gcTracked = true;
+        obj->gcIndex = static_cast<uint32_t>(objects.size());
+        objects.push_back(obj);
+    }
+    static void untrack(GcObject *obj) {
+        obj->gcTracked = false;
+        std::size_t hole = obj->gcIndex;
+        if (hole < oldCount) {
+            // Дыру в старом поколении закрывает его последний объект,
+            // а освободившееся место на границе — последний молодой
+            --oldCount;
+            move(oldCount, hole);
+            hole = oldCount;
+        }
+        move(objects.size() - 1, hole);
+        objects.pop_back();
+    }
+
+    // Пора ли собирать: молодых контейнеров набралось не меньше порога.
+    // Полная сборка — если с прошлой полной в старое поколение перешло больше,
+    // чем в нём тогда было (и не меньше, чем за десять молодых сборок).
+    static void collect_if_due() {
+        std::size_t young = objects.size() - oldCount;
+#if PY_GC_GENERATIONAL
+        if (young >= PY_GC_THRESHOLD) {
+            bool full = promotedSinceFull + young > std::max<std::size_t>(oldAfterFull, 10 * PY_GC_THRESHOLD);
+            collect(full ? 0 : oldCount);
+        }
+#else
+        if (young >= std::max<std::size_t>(PY_GC_THRESHOLD, oldCount)) {
+            collect(0);
+        }
+#endif
+    }
+    // Полная сборка
+    static void collect() { collect(0); }
+
+    static std::size_t tracked() { return objects.size(); }
+    static const GcStats &stats() { return totals; }
+
+private:
+    // Сборка контейнеров objects[first, size): 0 — всех, oldCount — молодых
+    static void collect(std::size_t first);
+    static bool in_scope(const Object *child, std::size_t first);
+
+    // При from == to ничего не делаем: в untrack старого объекта objects[from]
+    // может оказаться копией уже переехавшего указателя, и его индекс сбился бы
+    static void move(std::size_t from, std::size_t to) {
+        if (from != to) {
+            objects[to] = objects[from];
+            objects[to]->gcIndex = static_cast<uint32_t>(to);
+        }
+    }
+
+    static inline std::vector<GcObject*> objects;
+    static inline std::size_t oldCount = 0;
+    static inline std::size_t oldAfterFull = 0;         // размер старого поколения после полной сборки
+    static inline std::size_t promotedSinceFull = 0;
+    static inline bool collecting = false;
+    static inline GcStats totals;
 };
 
+inline GcObject::GcObject(Kind kind, bool tracked) : Object(kind) {
+    gcContainer = true;
+    if (tracked) {
+        GcHeap::track(this);
+    }
+}
+
+inline GcObject::~GcObject() {
+    if (gc_tracked()) {
+        GcHeap::untrack(this);
+    }
+}
+
+inline void GcObject::gc_track() {
+    if (!gc_tracked()) {
+        GcHeap::track(this);
+    }
+}
+
 // -----------------------------------------------------------------------------
 // PyNone
 // -----------------------------------------------------------------------------
 class PyNone : public Object {
 public:
-    PyNone() = default;
+    static constexpr Kind KIND = Kind::None;
+
+    PyNone() : Object(KIND) {}
+    std::size_t __hash__() const override {
+        return 0x9e3779b9u;
+    }
+    bool __eq__(const Object &other) const override {
+        return other.kind() == Kind::None;
+    }
     std::type_index type() const override {
         return typeid(PyNone);
     }
@@ -99,21 +384,53 @@ public:
 // -----------------------------------------------------------------------------
 // PyInt: объявление (тела методов будут определены ниже, после всех классов).
 // -----------------------------------------------------------------------------
+// Целое произвольной длины. Пока значение помещается в int64_t, оно лежит
+// в value и арифметика идёт машинными командами; при переполнении (ловим
+// через __builtin_*_overflow) результат становится длинным — BigInt в big.
+// Инвариант: длинным бывает только число вне int64_t, поэтому у каждого
+// значения одно представление. Создавать целые — через py_int(...).
+//
+// Флаг isBig объявлен первым: он ложится в хвостовое выравнивание Object,
+// и PyInt остаётся 24 байта, как и с обычным int.
 class PyInt : public Object {
-    int value;
+    bool isBig = false;
+    union {
+        int64_t value;
+        BigInt *big;
+    };
 public:
-    PyInt(int v);
+    static constexpr Kind KIND = Kind::Int;
+
+    PyInt(int64_t v);
+    explicit PyInt(BigInt v);   // только для значений вне int64_t (см. py_int)
+    ~PyInt() override;
     // Методы-операторы (__add__, __sub__ и т.д.) мы реализуем ниже,
     // после полной декларации PyBool, PyFloat, PyString, PyList и т.д.
     ObjectPtr __add__(ObjectPtr right) override;
     ObjectPtr __sub__(ObjectPtr right) override;
     ObjectPtr __mul__(ObjectPtr right) override;
     ObjectPtr __div__(ObjectPtr right) override;
+    ObjectPtr __or__(ObjectPtr right) override;
+    ObjectPtr __and__(ObjectPtr right) override;
+    ObjectPtr __xor__(ObjectPtr right) override;
+
+    // -x (у INT64_MIN результат уже длинный)
+    ObjectPtr negate() const;
+
+    std::size_t __hash__() const override;
+    bool __eq__(const Object &other) const override;
+    bool __lt__(const Object &other) const override;
 
     std::type_index type() const override;
     std::string repr() const override;
 
-    int get() const;
+    // Помещается ли значение в int64_t
+    bool is_small() const { return !isBig; }
+    // Значение как int64_t; у длинных — ближайшая граница int64_t
+    // (для индексов и счётчиков повторений это и так «вне диапазона»)
+    int64_t get() const;
+    BigInt to_big() const;
+    double to_double() const;
 };
 
 // -----------------------------------------------------------------------------
@@ -122,12 +439,18 @@ public:
 class PyBool : public Object {
     bool value;
 public:
+    static constexpr Kind KIND = Kind::Bool;
+
     PyBool(bool v);
     ObjectPtr __add__(ObjectPtr right) override;
     ObjectPtr __sub__(ObjectPtr right) override;
     ObjectPtr __mul__(ObjectPtr right) override;
     ObjectPtr __div__(ObjectPtr right) override;
 
+    std::size_t __hash__() const override;
+    bool __eq__(const Object &other) const override;
+    bool __lt__(const Object &other) const override;
+
     std::type_index type() const override;
     std::string repr() const override;
 
@@ -140,12 +463,18 @@ public:
 class PyFloat : public Object {
     double value;
 public:
+    static constexpr Kind KIND = Kind::Float;
+
     PyFloat(double v);
     ObjectPtr __add__(ObjectPtr right) override;
     ObjectPtr __sub__(ObjectPtr right) override;
     ObjectPtr __mul__(ObjectPtr right) override;
     ObjectPtr __div__(ObjectPtr right) override;
 
+    std::size_t __hash__() const override;
+    bool __eq__(const Object &other) const override;
+    bool __lt__(const Object &other) const override;
+
     std::type_index type() const override;
     std::string repr() const override;
 
@@ -155,53 +484,355 @@ public:
 // -----------------------------------------------------------------------------
 // PyString: объявление (реализацию – ниже).
 // -----------------------------------------------------------------------------
+// Строка может быть «верёвкой» (rope): s + t длиной от ROPE_MIN символов не
+// копирует текст, а запоминает обе половины. Текст склеивается (flatten) при
+// первом обращении к символам — get(), индекс, сравнение, хеш, repr, — после
+// чего половины отпускаются. Поэтому цикл s = s + piece работает за линейное
+// время и память, а не за квадратичное; len() берёт готовую длину и не клеит.
+// Если в цикле текст ещё и читают (s[i]), склейка дописывает в буфер прошлой
+// склейки, а не копирует его (см. flatten).
 class PyString : public Object {
-    std::string value;
+    mutable std::string value;
+    // Половины конкатенации; пусты, если текст уже лежит в value
+    mutable Ref<PyString> left, right;
+    std::size_t length;
 public:
+    static constexpr Kind KIND = Kind::String;
+    // Короче этого конкатенация копирует сразу: верёвка не окупается
+    static constexpr std::size_t ROPE_MIN = 256;
+
     PyString(std::string v);
+    PyString(Ref<PyString> l, Ref<PyString> r);
+    ~PyString() override;
+
     ObjectPtr __add__(ObjectPtr right) override;
     ObjectPtr __mul__(ObjectPtr right) override;
     ObjectPtr __getitem__(ObjectPtr idx) override;
     bool __contains__(ObjectPtr item) override;
 
+    std::size_t __hash__() const override;
+    bool __eq__(const Object &other) const override;
+    bool __lt__(const Object &other) const override;
+
     std::type_index type() const override;
     std::string repr() const override;
 
     const std::string &get() const;
+    std::size_t size() const { return length; }
+
+    // sep.join(...) — единственный метод строки
+    ObjectPtr __getattr__(const Ref<PyString> &name) override;
+
+    // Интернирована ли строка (см. py_intern)
+    bool is_interned() const { return interned; }
+
+private:
+    void flatten() const;
+    void release_halves() const;
+
+    // Строка неизменяема, поэтому хеш считается один раз
+    mutable std::size_t cachedHash = 0;
+    mutable bool hashed = false;
+    bool interned = false;
+
+    friend Ref<PyString> py_intern(std::string_view text);
 };
 
+// Строка длины 1 из таблицы (реализация — после PyString)
+inline const Ref<PyString> &py_char(char c);
+
 // -----------------------------------------------------------------------------
 // PyList: объявление (реализацию – ниже).
 // -----------------------------------------------------------------------------
-class PyList : public Object {
-    std::vector<ObjectPtr> elems;
+// Буфер элементов списка. Один буфер могут делить несколько списков
+// (a + [], a * 1) и снимки для обхода (генераторы списков): передача и
+// обход не копируют элементы. Список, который собирается записать в общий
+// буфер, сначала копирует его себе (copy-on-write, см. PyList::buffer_for_write).
+//
+// Стратегии хранения (как в PyPy): пока все элементы — короткие int, float
+// или bool, они лежат без упаковки в непрерывном массиве words (8 байт на
+// элемент вместо указателя на отдельный объект в куче). Объект для элемента
+// создаётся только при чтении (get). Первая запись элемента другого типа
+// переводит буфер в общее хранение ObjectPtr (generalize) — обратно он уже
+// не возвращается. Пустой буфер принимает стратегию первого элемента.
+class ListBuffer : public RefCounted {
+public:
+    enum class Strategy : uint8_t {
+        Empty,      // элементов ещё не было
+        Int,        // words — int64_t
+        Float,      // words — биты double
+        Bool,       // words — 0 или 1
+        Object      // items — произвольные объекты
+    };
+
+    ListBuffer() = default;
+    explicit ListBuffer(std::vector<ObjectPtr> v);
+    // Копия элементов для copy-on-write (счётчик ссылок у копии свой)
+    ListBuffer(const ListBuffer &other)
+        : RefCounted(), strat(other.strat), containers(other.containers),
+          words(other.words), items(other.items) {}
+
+    Strategy strategy() const { return strat; }
+    std::size_t size() const { return strat == Strategy::Object ? items.size() : words.size(); }
+    bool empty() const { return size() == 0; }
+    void reserve(std::size_t n);
+
+    // Элемент i (неупакованный — упаковывается)
+    ObjectPtr get(std::size_t i) const;
+    void set(std::size_t i, ObjectPtr value);
+    void push_back(ObjectPtr value);
+
+    // Неупакованный элемент стратегии s (слово — как в words); если
+    // стратегия другая, буфер обобщается и элемент упаковывается
+    void push_word(Strategy s, uint64_t word);
+    uint64_t word(std::size_t i) const { return words[i]; }
+
+    // Дописать все элементы other (без упаковки, если стратегии совпадают)
+    void extend(const ListBuffer &other);
+
+    // Все элементы как объекты (упаковывает неупакованные)
+    std::vector<ObjectPtr> objects() const;
+
+    // Для сборщика циклов: ссылки на объекты (есть только у Strategy::Object)
+    // и их сброс — буфер становится пустым
+    void gc_traverse(GcObject::Visit visit, void *ctx) const;
+    void clear();
+    // В буфер клали контейнер (список с таким буфером надо записать в GcHeap)
+    bool has_containers() const { return containers; }
+
+    // Стратегия, которую потребовал бы один элемент value
+    static Strategy strategy_of(const Object &value);
+    static uint64_t word_of(Strategy s, const Object &value);
+    static ObjectPtr box(Strategy s, uint64_t word);
+
+private:
+    Strategy strat = Strategy::Empty;
+    bool containers = false;
+    std::vector<uint64_t> words;
+    std::vector<ObjectPtr> items;
+
+    // Перейти к хранению ObjectPtr
+    void generalize();
+};
+
+class PyList : public GcObject {
+    Ref<ListBuffer> buf;
 public:
+    static constexpr Kind KIND = Kind::List;
+
+    // Ссылки для сборщика циклов (см. GcObject)
+    void gc_traverse(Visit visit, void *ctx) const override;
+    void gc_clear() override;
+
     PyList(std::vector<ObjectPtr> v);
+    explicit PyList(Ref<ListBuffer> shared);
     ObjectPtr __add__(ObjectPtr right) override;
     ObjectPtr __mul__(ObjectPtr right) override;
     ObjectPtr __getitem__(ObjectPtr idx) override;
     void __setitem__(ObjectPtr idx, ObjectPtr value) override;
     bool __contains__(ObjectPtr item) override;
 
+    // Поэлементное равенство и лексикографический порядок
+    bool __eq__(const Object &other) const override;
+    bool __lt__(const Object &other) const override;
+
     std::type_index type() const override;
     std::string repr() const override;
 
-    // Нам пригодится метод получения вектора элементов:
-    const std::vector<ObjectPtr>& getElements() const;
+    std::size_t size() const { return buf->size(); }
+    bool empty() const { return buf->empty(); }
+    // Элемент i без проверки границ (неупакованный упаковывается)
+    ObjectPtr item(std::size_t i) const { return buf->get(i); }
+    // Все элементы как объекты — копия с упаковкой, для редких случаев
+    std::vector<ObjectPtr> elements() const { return buf->objects(); }
+
+    // Текущий буфер — неизменный снимок элементов (запись в список его не тронет)
+    const Ref<ListBuffer> &buffer() const { return buf; }
+    // Буфер для записи: общий буфер сначала копируется
+    ListBuffer &buffer_for_write();
+
+    // Добавить элемент в конец (генераторы списков в байткоде)
+    void append(ObjectPtr value);
+};
+
+// -----------------------------------------------------------------------------
+// PyTuple: объявление (реализацию – ниже).
+// -----------------------------------------------------------------------------
+// Неизменяемая последовательность. Элементы лежат прямо за объектом — одно
+// выделение памяти на кортеж (из пула, см. pool.hpp), без отдельного вектора.
+// Кортеж хешируется по элементам и годится в ключи словаря и элементы
+// множества.
+class PyTuple final : public GcObject {
+public:
+    static constexpr Kind KIND = Kind::Tuple;
+
+    // Ссылки для сборщика циклов (см. GcObject)
+    void gc_traverse(Visit visit, void *ctx) const override;
+    void gc_clear() override;
+
+    // Кортеж из готовых элементов
+    static Ref<PyTuple> make(std::initializer_list<ObjectPtr> elems);
+    static Ref<PyTuple> from(const ListBuffer &elems);
+
+    ~PyTuple() override;
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const ObjectPtr &item(std::size_t i) const { return items()[i]; }
+
+    ObjectPtr __add__(ObjectPtr right) override;
+    ObjectPtr __getitem__(ObjectPtr idx) override;
+    bool __contains__(ObjectPtr item) override;
+
+    std::size_t __hash__() const override;
+    bool __eq__(const Object &other) const override;
+    bool __lt__(const Object &other) const override;
+
+    std::type_index type() const override;
+    std::string repr() const override;
+
+    // Память под кортеж из count элементов
+    struct Elements { std::size_t count; };
+    static void *operator new(std::size_t size, Elements n);
+    static void operator delete(void *p, Elements n);
+    // Деструктор вызывается здесь же: по длине считается размер блока для пула
+    static void operator delete(PyTuple *p, std::destroying_delete_t);
+
+private:
+    explicit PyTuple(std::size_t n);
+    // n пустых элементов; заполняют фабрики make/from
+    static Ref<PyTuple> allocate(std::size_t n);
+
+    ObjectPtr *items() { return reinterpret_cast<ObjectPtr*>(this + 1); }
+    const ObjectPtr *items() const { return reinterpret_cast<const ObjectPtr*>(this + 1); }
+
+    static std::size_t bytes_for(std::size_t n) { return sizeof(PyTuple) + n * sizeof(ObjectPtr); }
+
+    uint32_t count;
+};
+
+// -----------------------------------------------------------------------------
+// HashIndex: общий для PyDict и PySet хеш-индекс (как dict в CPython 3.6+).
+// Сами записи владелец хранит плотным массивом в порядке вставки, а индекс —
+// хеш каждой записи и разреженную таблицу slots с номерами записей
+// (EMPTY — свободно). Размер slots — степень двойки, заполнение не больше 2/3.
+// Поиск: хеш → слот, пробирование с perturb, сравнение сначала хешей, потом
+// __eq__. Удаления в языке нет, поэтому нет и «надгробий».
+//
+// keyOf(ix) — функция владельца, возвращающая ключ записи ix (const Object&).
+// -----------------------------------------------------------------------------
+class HashIndex {
+public:
+    static constexpr int32_t EMPTY = -1;
+
+    // Номер записи с ключом key или EMPTY
+    template <class KeyOf>
+    int32_t find(const Object &key, std::size_t hash, KeyOf keyOf) const {
+        return slots.empty() ? EMPTY : slots[probe(key, hash, keyOf)];
+    }
+
+    // Номер записи с ключом key; если ключа нет, он регистрируется под номером
+    // count (владелец должен тут же дописать запись) и second == true.
+    template <class KeyOf>
+    std::pair<int32_t, bool> insert(const Object &key, std::size_t hash, std::size_t count, KeyOf keyOf) {
+        if ((count + 1) * 3 > slots.size() * 2) {
+            rebuild(count + 1);
+        }
+        std::size_t slot = probe(key, hash, keyOf);
+        if (slots[slot] != EMPTY) {
+            return {slots[slot], false};
+        }
+        slots[slot] = static_cast<int32_t>(count);
+        hashes.push_back(hash);
+        return {slots[slot], true};
+    }
+
+    // Заранее расширить таблицу под count записей
+    void reserve(std::size_t count) {
+        if (count * 3 > slots.size() * 2) {
+            rebuild(count);
+        }
+    }
+
+    std::size_t hash_at(std::size_t ix) const { return hashes[ix]; }
+
+private:
+    std::vector<std::size_t> hashes;
+    std::vector<int32_t> slots;
+
+    // Слот с ключом key либо первый пустой слот на его цепочке (slots не пуст)
+    template <class KeyOf>
+    std::size_t probe(const Object &key, std::size_t hash, KeyOf keyOf) const {
+        const std::size_t mask = slots.size() - 1;
+        std::size_t perturb = hash;
+        std::size_t i = hash & mask;
+        while (true) {
+            int32_t ix = slots[i];
+            if (ix == EMPTY) {
+                return i;
+            }
+            if (hashes[ix] == hash) {
+                const Object &candidate = keyOf(ix);
+                if (&candidate == &key || candidate.__eq__(key)) {
+                    return i;
+                }
+            }
+            // Как в CPython: старшие биты хеша постепенно подмешиваются в индекс
+            perturb >>= 5;
+            i = (i * 5 + perturb + 1) & mask;
+        }
+    }
+
+    // Новая таблица slots под count записей. Ключи уже различны, поэтому
+    // каждая запись просто занимает первый свободный слот своей цепочки.
+    void rebuild(std::size_t count) {
+        std::size_t size = 8;
+        while (size * 2 < count * 3) {
+            size *= 2;
+        }
+        slots.assign(size, EMPTY);
+        const std::size_t mask = size - 1;
+        for (std::size_t ix = 0; ix < hashes.size(); ++ix) {
+            std::size_t perturb = hashes[ix];
+            std::size_t i = perturb & mask;
+            while (slots[i] != EMPTY) {
+                perturb >>= 5;
+                i = (i * 5 + perturb + 1) & mask;
+            }
+            slots[i] = static_cast<int32_t>(ix);
+        }
+    }
 };
 
 // -----------------------------------------------------------------------------
 // PyDict: объявление (реализацию – ниже).
 // -----------------------------------------------------------------------------
-class PyDict : public Object {
-    // храним (key,value), поиск по key->repr()
+class PyDict : public GcObject {
+    // Пары (key, value) в порядке вставки; поиск — через index
     std::vector<std::pair<ObjectPtr,ObjectPtr>> items;
+    HashIndex index;
+
+    auto key_of() const {
+        return [this](std::size_t ix) -> const Object& { return *items[ix].first; };
+    }
 public:
+    static constexpr Kind KIND = Kind::Dict;
+
+    // Ссылки для сборщика циклов (см. GcObject)
+    void gc_traverse(Visit visit, void *ctx) const override;
+    void gc_clear() override;
+
     PyDict();
-    void __setitem__(ObjectPtr key, ObjectPtr val);
+    void __setitem__(ObjectPtr key, ObjectPtr val) override;
     ObjectPtr __getitem__(ObjectPtr idx) override;
     bool __contains__(ObjectPtr idx) override;
 
+    // Значение по ключу или nullptr, если ключа нет (один поиск вместо __contains__ + __getitem__)
+    ObjectPtr get(const Object &key) const;
+
+    // Равны, если совпадают наборы ключей и значения при них (порядок не важен)
+    bool __eq__(const Object &other) const override;
+
     std::type_index type() const override;
     std::string repr() const override;
 
@@ -211,14 +842,41 @@ public:
 // -----------------------------------------------------------------------------
 // PySet: объявление (реализацию – ниже).
 // -----------------------------------------------------------------------------
-class PySet : public Object {
+class PySet : public GcObject {
+    // Элементы в порядке вставки; поиск — через тот же HashIndex, что у PyDict
     std::vector<ObjectPtr> elems;
+    HashIndex index;
+
+    auto key_of() const {
+        return [this](std::size_t ix) -> const Object& { return *elems[ix]; };
+    }
 public:
+    static constexpr Kind KIND = Kind::Set;
+
+    // Ссылки для сборщика циклов (см. GcObject)
+    void gc_traverse(Visit visit, void *ctx) const override;
+    void gc_clear() override;
+
     PySet();
     PySet(std::vector<ObjectPtr> v);
-    ObjectPtr __add__(ObjectPtr right) override; // union ( | )
+
+    // Добавить элемент, если его ещё нет
+    void add(ObjectPtr item);
+    // Есть ли элемент (без Ref — годится и временный ключ)
+    bool has(const Object &item) const;
+
+    // Алгебра множеств; порядок результата — как при обходе левого операнда,
+    // затем правого (пересечение — в порядке меньшего операнда)
+    ObjectPtr __add__(ObjectPtr right) override; // объединение, как |
+    ObjectPtr __or__(ObjectPtr right) override;  // объединение
+    ObjectPtr __and__(ObjectPtr right) override; // пересечение
+    ObjectPtr __sub__(ObjectPtr right) override; // разность
+    ObjectPtr __xor__(ObjectPtr right) override; // симметрическая разность
     bool __contains__(ObjectPtr item) override;
 
+    // Равны, если состоят из одних и тех же элементов (порядок не важен)
+    bool __eq__(const Object &other) const override;
+
     std::type_index type() const override;
     std::string repr() const override;
 
@@ -232,6 +890,8 @@ class PyBuiltinFunction : public Object {
     std::string name;
     std::function<ObjectPtr(const std::vector<ObjectPtr>&)> fn;
 public:
+    static constexpr Kind KIND = Kind::BuiltinFunction;
+
     PyBuiltinFunction(std::string name, std::function<ObjectPtr(const std::vector<ObjectPtr>&)> fn);
     ObjectPtr __call__(const std::vector<ObjectPtr> &args) override;
 
@@ -242,25 +902,46 @@ public:
 // -----------------------------------------------------------------------------
 // PyFunction: объявление (реализацию – ниже).
 // -----------------------------------------------------------------------------
-class PyFunction : public Object {
+// Ячейка для переменной, захваченной замыканием. Её разделяют кадр
+// объемлющей функции и все PyFunction, созданные внутри него, поэтому
+// присваивание в объемлющей функции видно во вложенной и наоборот.
+struct Cell {
+    ObjectPtr value;
+};
+
+class PyFunction : public GcObject {
     // Имя функции (чтобы было понятно, как она называется при repr())
     std::string name;
     // AST-узел, в котором описано тело (FuncDecl* позволяет нам найти posParams, defaultParams и сам код)
     FuncDecl *decl;
     // Лексическое окружение (таблица символов), где функция была объявлена, 
     // чтобы обеспечить замыкания (клаузуру)
-    std::shared_ptr<SymbolTable> scope;
+    // Слабая ссылка: таблица модуля хранит саму функцию, и сильная ссылка
+    // замкнула бы цикл таблица → функция → таблица
+    std::weak_ptr<SymbolTable> scope;
     // Список имён позиционных (обязательных) параметров
     std::vector<std::string> posParams;
     // Вектор заранее вычисленных default-значений (порядок тот же, что и в decl->defaultParams)
     std::vector<ObjectPtr> defaultValues;
+    // Интерпретатор, создавший функцию: через него выполняется тело при __call__
+    Executor *interpreter;
+    // Захваченные ячейки свободных переменных (в порядке FuncDecl::freeSources)
+    std::vector<std::shared_ptr<Cell>> closure;
 
 public:
+    static constexpr Kind KIND = Kind::Function;
+
+    // Ссылки для сборщика циклов (см. GcObject)
+    void gc_traverse(Visit visit, void *ctx) const override;
+    void gc_clear() override;
+
     PyFunction(const std::string &funcName,
                FuncDecl *f,
                std::shared_ptr<SymbolTable> enclosingEnv,
+               Executor *interp,
                const std::vector<std::string> &parameters,
-               std::vector<ObjectPtr> defaults);
+               std::vector<ObjectPtr> defaults,
+               std::vector<std::shared_ptr<Cell>> closureCells = {});
 
     
     const std::vector<std::string>& getPosParams() const {
@@ -271,6 +952,14 @@ public:
         return defaultValues;
     }
 
+    std::shared_ptr<SymbolTable> getScope() const {
+        return scope.lock();
+    }
+
+    const std::vector<std::shared_ptr<Cell>>& getClosure() const {
+        return closure;
+    }
+
     ObjectPtr __call__(const std::vector<ObjectPtr> &args) override;
 
     std::type_index type() const override;
@@ -280,54 +969,178 @@ public:
 };
 
 // -----------------------------------------------------------------------------
-// PyInstance и PyClass (у них я оставил всё как есть, реализации внутри класса – в порядке).
+// Shape — «скрытый класс» экземпляра (как в V8): список имён атрибутов в
+// порядке их появления, имя i хранится в слоте i экземпляра. Экземпляры,
+// которым атрибуты присваивались в одном порядке (обычно — в __init__),
+// делят одну форму, поэтому место обращения к атрибуту может запомнить
+// (форма, слот) и дальше читать слот без поиска (AttrCache).
+//
+// Формы образуют дерево переходов от общей пустой формы root(): добавление
+// атрибута name ведёт в дочернюю форму, и переход запоминается, чтобы
+// следующий экземпляр попал в ту же форму. Формы не удаляются из дерева.
+// Имена — интернированные строки, поэтому сравниваются по адресу.
 // -----------------------------------------------------------------------------
-class PyInstance : public Object {
+class Shape : public RefCounted {
 public:
-    std::shared_ptr<PyClass> classPtr;
-    std::shared_ptr<PyDict> instanceDict;
+    // Уникальный номер формы; кэши хранят его, а не указатель
+    const uint32_t id;
+
+    static const Ref<Shape> &root();
+
+    // Слот атрибута или -1
+    int slot_of(const PyString *name) const;
+    std::size_t size() const { return names.size(); }
 
-    PyInstance(std::shared_ptr<PyClass> cls);
+    // Форма с тем же набором имён плюс name в конце
+    const Ref<Shape> &with(const PyString *name);
+
+private:
+    Shape() : id(nextId++) {}
+
+    static inline uint32_t nextId = 1;
+
+    std::vector<const PyString*> names;
+    std::vector<std::pair<const PyString*, Ref<Shape>>> transitions;
+};
 
-    // Сначала смотрим в instanceDict, потом – в classPtr->classDict
-    ObjectPtr __getattr__(const std::string &name) override;
-    void __setattr__(const std::string &name, ObjectPtr value) override;
+// -----------------------------------------------------------------------------
+// PyInstance и PyClass (у них я оставил всё как есть, реализации внутри класса – в порядке).
+// -----------------------------------------------------------------------------
+class PyInstance : public GcObject {
+public:
+    static constexpr Kind KIND = Kind::Instance;
+
+    // Ссылки для сборщика циклов (см. GcObject)
+    void gc_traverse(Visit visit, void *ctx) const override;
+    void gc_clear() override;
+
+    Ref<PyClass> classPtr;
+
+    // Новый экземпляр класса cls (см. PyClass::seal_layout): у класса со
+    // __slots__ значения атрибутов лежат в массиве сразу за объектом — одно
+    // выделение памяти на экземпляр, набор атрибутов фиксирован.
+    static Ref<PyInstance> create(Ref<PyClass> cls);
+    ~PyInstance() override;
+
+    // Для массива значений за объектом. Память — из пула (см. pool.hpp);
+    // при освобождении размер блока восстанавливается по форме экземпляра.
+    struct InlineSlots { std::size_t count; };
+    static void *operator new(std::size_t size) { return Pool::allocate(size); }
+    static void *operator new(std::size_t size, InlineSlots extra) {
+        return Pool::allocate(size + extra.count * sizeof(ObjectPtr));
+    }
+    // Пара к operator new на случай исключения в конструкторе
+    static void operator delete(void *p, std::size_t size) { Pool::deallocate(p, size); }
+    static void operator delete(void *p, InlineSlots extra) {
+        Pool::deallocate(p, sizeof(PyInstance) + extra.count * sizeof(ObjectPtr));
+    }
+    static void operator delete(PyInstance *p, std::destroying_delete_t);
+
+    // Сначала смотрим в слоты экземпляра, потом – в classPtr->classDict
+    ObjectPtr __getattr__(const Ref<PyString> &name) override;
+    void __setattr__(const Ref<PyString> &name, ObjectPtr value) override;
+
+    // Слот атрибута name этого экземпляра или nullptr, если такого нет.
+    // При совпадении формы с cache — без поиска; иначе кэш обновляется
+    // (запоминается и отсутствие: тогда атрибут ищут сразу в классе).
+    // Слот из __slots__, которому ещё ничего не присвоили, пуст (nullptr внутри).
+    ObjectPtr *slot_for(const PyString &name, AttrCache &cache);
     ObjectPtr __call__(const std::vector<ObjectPtr> & /*args*/) override;
 
+    std::size_t __hash__() const override;
+    bool __eq__(const Object &other) const override;
+
     std::string repr() const override;
     std::type_index type() const override;
+
+private:
+    PyInstance(Ref<PyClass> cls, Ref<Shape> initial, bool inlineValues);
+
+    Ref<Shape> shape;
+    // Значение атрибута shape->names[i] — values[i]; заполнено shape->size()
+    // элементов. У класса со __slots__ массив лежит сразу за объектом, иначе —
+    // отдельно в куче, и его ёмкость выводится из размера (capacity_for).
+    ObjectPtr *values;
+
+    ObjectPtr *inline_values() { return reinterpret_cast<ObjectPtr*>(this + 1); }
+    static std::size_t capacity_for(std::size_t count);
 };
 
-class PyClass : public Object, public std::enable_shared_from_this<PyClass> {
+class PyClass : public GcObject {
 public:
+    static constexpr Kind KIND = Kind::Class;
+
+    // Ссылки для сборщика циклов (см. GcObject)
+    void gc_traverse(Visit visit, void *ctx) const override;
+    void gc_clear() override;
+
     // Имя класса
     std::string name;
     // Словарь атрибутов/методов данного класса
-    std::shared_ptr<PyDict> classDict;
+    Ref<PyDict> classDict;
+
+    // Базовые классы в порядке объявления (пусто, если класс не наследуется)
+    std::vector<Ref<PyClass>> bases;
+
+    // Порядок поиска атрибутов (MRO): сам класс, затем предки по
+    // C3-линеаризации, как в Python. Считается один раз в конструкторе;
+    // предков держат bases, поэтому указатели обычные.
+    std::vector<PyClass*> mro;
 
-    // Указатель на родительский класс (nullptr, если класс не наследуется)
-    std::shared_ptr<PyClass> parent;
+    // Бросает RuntimeError, если согласованного MRO для bases нет
+    PyClass(std::string className, std::vector<Ref<PyClass>> baseClasses = {});
+    ~PyClass() override;
 
-    // Конструктор: теперь принимает имя класса и (опционально) родителя
-    PyClass(std::string className, std::shared_ptr<PyClass> baseClass = nullptr);
+    // Вызывается, когда тело класса исполнено: по __slots__ (своим и баз)
+    // фиксирует раскладку экземпляров — начальную форму и смещения атрибутов.
+    // Бросает RuntimeError при неверных __slots__ или конфликте раскладок баз.
+    void seal_layout();
 
-    // При запросе атрибута: сначала ищем в classDict, 
-    // если не нашли и parent != nullptr — идём к parent
-    ObjectPtr __getattr__(const std::string &attrName) override;
+    // Начальная форма экземпляров (атрибуты из __slots__ по порядку)
+    const Ref<Shape> &instance_shape() const { return instanceShape; }
+    // Набор атрибутов экземпляров фиксирован: __slots__ есть у класса и у всех баз
+    bool fixed_layout() const { return fixedLayout; }
 
-    // Запись атрибута в classDict без помех; parent остается неизменным
-    void __setattr__(const std::string &attrName, ObjectPtr value) override;
+    // Атрибут класса с учётом MRO или nullptr, если его нет нигде.
+    // Результат (и отсутствие) запоминается в attrCache.
+    ObjectPtr lookup(const PyString &attrName);
+
+    // lookup, но отсутствие атрибута — RuntimeError
+    ObjectPtr __getattr__(const Ref<PyString> &attrName) override;
+
+    // Запись атрибута в classDict; сбрасывает кэш поиска у класса и всех наследников
+    void __setattr__(const Ref<PyString> &attrName, ObjectPtr value) override;
 
     // Вызов конструктора класса: создаём экземпляр, затем вызываем __init__, 
-    // причём __init__ может быть унаследован из parent, если не переопределён.
+    // причём __init__ может быть унаследован от предка, если не переопределён.
     ObjectPtr __call__(const std::vector<ObjectPtr> &args) override;
 
+    std::size_t __hash__() const override;
+    bool __eq__(const Object &other) const override;
+
     std::string repr() const override;
     std::type_index type() const override;
     
-    std::shared_ptr<PyDict> getClassDict() const {
+    Ref<PyDict> getClassDict() const {
         return classDict;
     }
+
+private:
+    // Плоский кэш поиска по MRO: интернированное имя → найденный объект
+    // (nullptr — атрибута нет). Унаследованный метод после первого обращения
+    // находится одним поиском в хеш-таблице, а не обходом всех предков.
+    std::unordered_map<const PyString*, ObjectPtr> attrCache;
+
+    // Прямые наследники — им тоже сбрасывается кэш при записи атрибута.
+    // Наследник держит ссылку на базу, а не наоборот, и сам вычёркивает
+    // себя отсюда в деструкторе.
+    std::vector<PyClass*> subclasses;
+
+    Ref<Shape> instanceShape = Shape::root();
+    bool fixedLayout = false;
+
+    void invalidate_cache();
+    static std::vector<PyClass*> linearize(const std::vector<Ref<PyClass>> &bases);
 };
 
 // -----------------------------------------------------------------------------
@@ -335,262 +1148,497 @@ public:
 // можно дать полные тела всех методов, которые ранее ссылались на методы других классов.
 // -----------------------------------------------------------------------------
 
-// -------------------- PyInt --------------------
-inline PyInt::PyInt(int v) : value(v) {}
-
-inline ObjectPtr PyInt::__add__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        return std::make_shared<PyInt>(value + r->value);
-    }
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        // r->get() теперь допустим, потому что PyBool уже полностью определён
-        return std::make_shared<PyInt>(value + (r->get() ? 1 : 0));
-    }
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        // r->get() допустим, потому что PyFloat уже определён
-        return std::make_shared<PyFloat>(value + r->get());
-    }
-    throw RuntimeError("unsupported operand types for +: 'int' and '" + right->repr() + "'");
+// -------------------- Фабрики скаляров --------------------
+// None, True, False и целые из [PY_SMALL_INT_MIN, PY_SMALL_INT_MAX] неизменяемы,
+// поэтому создаются один раз и дальше раздаются как общие объекты.
+// Создавать скаляры нужно через py_none/py_bool/py_int, а не make_ref.
+#ifndef PY_SMALL_INT_MIN
+#define PY_SMALL_INT_MIN (-5)
+#endif
+#ifndef PY_SMALL_INT_MAX
+#define PY_SMALL_INT_MAX 1024
+#endif
+
+inline ObjectPtr py_none() {
+    static const ObjectPtr none = make_ref<PyNone>();
+    return none;
 }
 
-inline ObjectPtr PyInt::__sub__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        return std::make_shared<PyInt>(value - r->value);
-    }
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        return std::make_shared<PyInt>(value - (r->get() ? 1 : 0));
-    }
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        return std::make_shared<PyFloat>(value - r->get());
-    }
-    throw RuntimeError("unsupported operand types for -: 'int' and '" + right->repr() + "'");
+inline ObjectPtr py_bool(bool value) {
+    static const ObjectPtr trueObj = make_ref<PyBool>(true);
+    static const ObjectPtr falseObj = make_ref<PyBool>(false);
+    return value ? trueObj : falseObj;
 }
 
-inline ObjectPtr PyInt::__mul__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        return std::make_shared<PyInt>(value * r->value);
-    }
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        return std::make_shared<PyInt>(value * (r->get() ? 1 : 0));
-    }
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        return std::make_shared<PyFloat>(value * r->get());
-    }
-    if (auto r = std::dynamic_pointer_cast<PyString>(right)) {
-        // int * str → повторение строки
-        int times = value;
-        if (times < 0) times = 0;
-        std::string base = r->get();  // r->get() допустим
-        std::string accum;
-        for (int i = 0; i < times; ++i) {
-            accum += base;
-        }
-        return std::make_shared<PyString>(accum);
-    }
-    if (auto r = std::dynamic_pointer_cast<PyList>(right)) {
-        // int * list → повторение списка
-        int times = value;
-        if (times < 0) times = 0;
-        const auto &base = r->getElements();  // getElements() допустим
-        std::vector<ObjectPtr> accum;
-        for (int i = 0; i < times; ++i) {
-            for (auto &el : base) {
-                accum.push_back(el);
-            }
+inline ObjectPtr py_int(int64_t value) {
+    static const std::vector<ObjectPtr> smallInts = [] {
+        std::vector<ObjectPtr> cache;
+        cache.reserve(PY_SMALL_INT_MAX - PY_SMALL_INT_MIN + 1);
+        for (int i = PY_SMALL_INT_MIN; i <= PY_SMALL_INT_MAX; ++i) {
+            cache.push_back(make_ref<PyInt>(i));
         }
-        return std::make_shared<PyList>(std::move(accum));
+        return cache;
+    }();
+    if (value >= PY_SMALL_INT_MIN && value <= PY_SMALL_INT_MAX) {
+        return smallInts[value - PY_SMALL_INT_MIN];
     }
-    throw RuntimeError("unsupported operand types for *: 'int' and '" + right->repr() + "'");
+    return make_ref<PyInt>(value);
 }
 
-inline ObjectPtr PyInt::__div__(ObjectPtr right) {
-    double a = value;
-    double b;
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        b = r->value;
-    } else if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        b = r->get() ? 1.0 : 0.0;
-    } else if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        b = r->get();
-    } else {
-        throw RuntimeError("unsupported operand types for /: 'int' and '" + right->repr() + "'");
-    }
-    if (b == 0.0) {
-        throw RuntimeError("ZeroDivisionError: division by zero");
+// Результат длинной арифметики: если влез в int64_t — обычное короткое целое
+inline ObjectPtr py_int(BigInt value) {
+    if (value.fits_int64()) {
+        return py_int(value.to_int64());
     }
-    return std::make_shared<PyFloat>(a / b);
+    return make_ref<PyInt>(std::move(value));
 }
 
-inline std::type_index PyInt::type() const {
-    return typeid(PyInt);
+// Правый операнд float-арифметики (и сравнения чисел) как double;
+// false — если это не число
+inline bool float_operand(const Object &right, double &out) {
+    switch (right.kind()) {
+        case Kind::Float: out = static_cast<const PyFloat&>(right).get(); return true;
+        case Kind::Int:   out = static_cast<const PyInt&>(right).to_double(); return true;
+        case Kind::Bool:  out = static_cast<const PyBool&>(right).get() ? 1.0 : 0.0; return true;
+        default:          return false;
+    }
 }
 
-inline std::string PyInt::repr() const {
-    return std::to_string(value);
+// Целый операнд: int как есть, bool — общий объект 0 или 1; nullptr — не целое
+inline const PyInt *int_operand(const Object &right) {
+    switch (right.kind()) {
+        case Kind::Int:  return &static_cast<const PyInt&>(right);
+        case Kind::Bool: return &static_cast<const PyInt&>(*py_int(static_cast<const PyBool&>(right).get()));
+        default:         return nullptr;
+    }
 }
 
-inline int PyInt::get() const {
-    return value;
+// Число повторений для str * n и list * n из n (int или bool): отрицательное —
+// ноль, как в Python. Длинное n (любого знака, как в CPython) или результат
+// больше max элементов (length * n переполняется) — OverflowError вместо
+// зависания или std::length_error.
+inline std::size_t repeat_count(const PyInt &times, std::size_t length, std::size_t max, const char *what) {
+    if (!times.is_small()) {
+        throw RuntimeError(std::string("OverflowError: repeated ") + what + " is too long");
+    }
+    if (times.get() <= 0 || length == 0) {
+        return 0;
+    }
+    std::size_t total;
+    if (__builtin_mul_overflow(static_cast<std::size_t>(times.get()), length, &total)
+        || total > max) {
+        throw RuntimeError(std::string("OverflowError: repeated ") + what + " is too long");
+    }
+    return static_cast<std::size_t>(times.get());
 }
 
-// -------------------- PyBool --------------------
-inline PyBool::PyBool(bool v) : value(v) {}
-
-inline ObjectPtr PyBool::__add__(ObjectPtr right) {
-    int a = value ? 1 : 0;
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        int b = r->get();
-        return std::make_shared<PyInt>(a + b);
+// Точное сравнение целого с float (b — не NaN): <0, 0, >0, как a <=> b.
+// Через double нельзя: 2**53 + 1 округлилось бы и стало равно 2.0**53,
+// хотя хеши у них разные.
+inline int compare_int_float(int64_t a, double b) {
+    if (b >= 9223372036854775808.0) {
+        return -1;
     }
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        return std::make_shared<PyInt>(a + r->get());
+    if (b < -9223372036854775808.0) {
+        return 1;
     }
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        return std::make_shared<PyFloat>(a + r->get());
+    double whole = std::trunc(b);
+    int64_t w = static_cast<int64_t>(whole);
+    if (a != w) {
+        return a < w ? -1 : 1;
     }
-    throw RuntimeError("unsupported operand types for +: 'bool' and '" + right->repr() + "'");
+    return whole < b ? -1 : whole > b ? 1 : 0;
 }
 
-inline ObjectPtr PyBool::__sub__(ObjectPtr right) {
-    int a = value ? 1 : 0;
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        int b = r->get();
-        return std::make_shared<PyInt>(a - b);
+inline int compare_int_float(const PyInt &a, double b) {
+    if (a.is_small()) {
+        return compare_int_float(a.get(), b);
     }
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        return std::make_shared<PyInt>(a - r->get());
+    if (std::isinf(b)) {
+        return b > 0 ? -1 : 1;
     }
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        return std::make_shared<PyFloat>(a - r->get());
+    double whole = std::trunc(b);
+    if (int c = compare(a.to_big(), BigInt::from_double(whole))) {
+        return c;
     }
-    throw RuntimeError("unsupported operand types for -: 'bool' and '" + right->repr() + "'");
+    return whole < b ? -1 : whole > b ? 1 : 0;
 }
 
-inline ObjectPtr PyBool::__mul__(ObjectPtr right) {
-    int a = value ? 1 : 0;
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        int b = r->get();
-        return std::make_shared<PyInt>(a * b);
-    }
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        return std::make_shared<PyInt>(a * r->get());
-    }
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        return std::make_shared<PyFloat>(a * r->get());
-    }
-    if (auto r = std::dynamic_pointer_cast<PyString>(right)) {
-        // bool * str → конвертируем bool в int
-        int times = a;
-        if (times < 0) times = 0;
-        std::string base = r->get();
-        std::string accum;
-        for (int i = 0; i < times; ++i) {
-            accum += base;
-        }
-        return std::make_shared<PyString>(accum);
-    }
-    if (auto r = std::dynamic_pointer_cast<PyList>(right)) {
-        int times = a;
-        if (times < 0) times = 0;
-        const auto &base = r->getElements();
-        std::vector<ObjectPtr> accum;
-        for (int i = 0; i < times; ++i) {
-            for (auto &el : base) {
-                accum.push_back(el);
-            }
+// Целочисленные + - * | & ^. Короткие числа — в int64_t; при переполнении
+// или длинном операнде — через BigInt (py_int сам вернёт короткое, если влезет).
+inline ObjectPtr int_arith(char op, const PyInt &a, const PyInt &b) {
+    if (a.is_small() && b.is_small()) {
+        int64_t x = a.get();
+        int64_t y = b.get();
+        int64_t r;
+        bool overflow = false;
+        switch (op) {
+            case '+': overflow = __builtin_add_overflow(x, y, &r); break;
+            case '-': overflow = __builtin_sub_overflow(x, y, &r); break;
+            case '*': overflow = __builtin_mul_overflow(x, y, &r); break;
+            case '|': r = x | y; break;
+            case '&': r = x & y; break;
+            default:  r = x ^ y; break;
+        }
+        if (!overflow) {
+            return py_int(r);
         }
-        return std::make_shared<PyList>(std::move(accum));
     }
-    throw RuntimeError("unsupported operand types for *: 'bool' and '" + right->repr() + "'");
-}
-
-inline ObjectPtr PyBool::__div__(ObjectPtr right) {
-    double a = value ? 1.0 : 0.0;
-    double b;
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        b = r->get() ? 1.0 : 0.0;
-    } else if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        b = r->get();
-    } else if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        b = r->get();
-    } else {
-        throw RuntimeError("unsupported operand types for /: 'bool' and '" + right->repr() + "'");
+    // x & маска (маска — неотрицательное короткое): результат определяют
+    // младшие 64 бита длинного операнда, BigInt-арифметика не нужна
+    if (op == '&') {
+        const PyInt &mask = a.is_small() ? a : b;
+        const PyInt &other = a.is_small() ? b : a;
+        if (mask.is_small() && mask.get() >= 0) {
+            return py_int(static_cast<int64_t>(other.to_big().low_bits() & static_cast<uint64_t>(mask.get())));
+        }
     }
-    if (b == 0.0) {
-        throw RuntimeError("ZeroDivisionError: division by zero");
+    BigInt x = a.to_big();
+    BigInt y = b.to_big();
+    switch (op) {
+        case '+': return py_int(x + y);
+        case '-': return py_int(x - y);
+        case '*': return py_int(x * y);
+        case '|': return py_int(x | y);
+        case '&': return py_int(x & y);
+        default:  return py_int(x ^ y);
     }
-    return std::make_shared<PyFloat>(a / b);
 }
 
-inline std::type_index PyBool::type() const {
-    return typeid(PyBool);
-}
+// -------------------- PyInt --------------------
+inline PyInt::PyInt(int64_t v) : Object(KIND), value(v) {}
 
-inline std::string PyBool::repr() const {
-    return value ? "True" : "False";
-}
+inline PyInt::PyInt(BigInt v) : Object(KIND), isBig(true), big(new BigInt(std::move(v))) {}
 
-inline bool PyBool::get() const {
-    return value;
+inline PyInt::~PyInt() {
+    if (isBig) {
+        delete big;
+    }
 }
 
-// -------------------- PyFloat --------------------
-inline PyFloat::PyFloat(double v) : value(v) {}
-
-inline ObjectPtr PyFloat::__add__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        return std::make_shared<PyFloat>(value + r->value);
-    }
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        return std::make_shared<PyFloat>(value + r->get());
+// Смешанная арифметика: вид правого операнда разбираем switch'ем по Kind.
+// bool участвует как 0/1, int с float даёт float.
+inline ObjectPtr PyInt::__add__(ObjectPtr right) {
+    if (const PyInt *r = int_operand(*right)) {
+        return int_arith('+', *this, *r);
     }
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        return std::make_shared<PyFloat>(value + (r->get() ? 1.0 : 0.0));
+    if (right->kind() == Kind::Float) {
+        return make_ref<PyFloat>(to_double() + static_cast<PyFloat&>(*right).get());
     }
-    throw RuntimeError("unsupported operand types for +: 'float' and '" + right->repr() + "'");
+    throw RuntimeError("unsupported operand types for +: 'int' and '" + right->repr() + "'");
 }
 
-inline ObjectPtr PyFloat::__sub__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        return std::make_shared<PyFloat>(value - r->value);
+inline ObjectPtr PyInt::__sub__(ObjectPtr right) {
+    if (const PyInt *r = int_operand(*right)) {
+        return int_arith('-', *this, *r);
     }
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        return std::make_shared<PyFloat>(value - r->get());
+    if (right->kind() == Kind::Float) {
+        return make_ref<PyFloat>(to_double() - static_cast<PyFloat&>(*right).get());
     }
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        return std::make_shared<PyFloat>(value - (r->get() ? 1.0 : 0.0));
+    throw RuntimeError("unsupported operand types for -: 'int' and '" + right->repr() + "'");
+}
+
+inline ObjectPtr PyInt::__mul__(ObjectPtr right) {
+    if (const PyInt *r = int_operand(*right)) {
+        return int_arith('*', *this, *r);
+    }
+    switch (right->kind()) {
+        case Kind::Float: return make_ref<PyFloat>(to_double() * static_cast<PyFloat&>(*right).get());
+        case Kind::String:
+            // int * str → повторение строки (то же, что str * int)
+            return static_cast<PyString&>(*right).__mul__(ObjectPtr(this));
+        case Kind::List:
+            // int * list → повторение списка (то же, что list * int)
+            return static_cast<PyList&>(*right).__mul__(ObjectPtr(this));
+        default: break;
     }
-    throw RuntimeError("unsupported operand types for -: 'float' and '" + right->repr() + "'");
+    throw RuntimeError("unsupported operand types for *: 'int' and '" + right->repr() + "'");
 }
 
-inline ObjectPtr PyFloat::__mul__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        return std::make_shared<PyFloat>(value * r->value);
+inline ObjectPtr PyInt::__div__(ObjectPtr right) {
+    // Длинное целое не помещается в double (inf / inf дало бы nan): делим
+    // мантиссы и отдельно вычитаем двоичные порядки
+    const PyInt *r = int_operand(*right);
+    if (r && (isBig || r->isBig)) {
+        if (!r->isBig && r->value == 0) {
+            throw RuntimeError("ZeroDivisionError: division by zero");
+        }
+        long ea, eb;
+        double ma = to_big().to_frexp(ea);
+        double mb = r->to_big().to_frexp(eb);
+        long exp = ea - eb;
+        // |ma / mb| в (0.5, 2): за пределами этих порядков — переполнение или ноль
+        if (exp > 1100) {
+            throw RuntimeError("OverflowError: integer division result too large for a float");
+        }
+        double q = std::ldexp(ma / mb, static_cast<int>(std::max<long>(exp, -1100)));
+        if (std::isinf(q)) {
+            throw RuntimeError("OverflowError: integer division result too large for a float");
+        }
+        return make_ref<PyFloat>(q);
+    }
+    double b;
+    if (!float_operand(*right, b)) {
+        throw RuntimeError("unsupported operand types for /: 'int' and '" + right->repr() + "'");
+    }
+    if (b == 0.0) {
+        throw RuntimeError("ZeroDivisionError: division by zero");
+    }
+    return make_ref<PyFloat>(to_double() / b);
+}
+
+inline ObjectPtr PyInt::__or__(ObjectPtr right) {
+    if (const PyInt *r = int_operand(*right)) {
+        return int_arith('|', *this, *r);
+    }
+    throw RuntimeError("unsupported operand types for |: 'int' and '" + right->repr() + "'");
+}
+
+inline ObjectPtr PyInt::__and__(ObjectPtr right) {
+    if (const PyInt *r = int_operand(*right)) {
+        return int_arith('&', *this, *r);
+    }
+    throw RuntimeError("unsupported operand types for &: 'int' and '" + right->repr() + "'");
+}
+
+inline ObjectPtr PyInt::__xor__(ObjectPtr right) {
+    if (const PyInt *r = int_operand(*right)) {
+        return int_arith('^', *this, *r);
+    }
+    throw RuntimeError("unsupported operand types for ^: 'int' and '" + right->repr() + "'");
+}
+
+inline ObjectPtr PyInt::negate() const {
+    if (isBig) {
+        return py_int(-*big);
     }
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        return std::make_shared<PyFloat>(value * r->get());
+    if (value == INT64_MIN) {
+        return py_int(-BigInt(value));
     }
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        return std::make_shared<PyFloat>(value * (r->get() ? 1.0 : 0.0));
+    return py_int(-value);
+}
+
+// Целые и float, равные численно, — один и тот же ключ (как в Python),
+// поэтому float с целым значением хешируется как int. Длинное целое
+// хешируется как свой double: равный ему float даст тот же хеш.
+inline std::size_t PyInt::__hash__() const {
+    if (isBig) {
+        return std::hash<double>{}(big->to_double());
+    }
+    return std::hash<long long>{}(value);
+}
+
+inline bool PyInt::__eq__(const Object &other) const {
+    switch (other.kind()) {
+        case Kind::Int: {
+            const auto &r = static_cast<const PyInt&>(other);
+            if (!isBig && !r.isBig) {
+                return value == r.value;
+            }
+            // Короткое и длинное равными не бывают (см. инвариант PyInt)
+            return isBig && r.isBig && *big == *r.big;
+        }
+        case Kind::Bool: return !isBig && value == (static_cast<const PyBool&>(other).get() ? 1 : 0);
+        case Kind::Float: {
+            double b = static_cast<const PyFloat&>(other).get();
+            return !std::isnan(b) && compare_int_float(*this, b) == 0;
+        }
+        default:          return false;
+    }
+}
+
+inline bool PyInt::__lt__(const Object &other) const {
+    if (const PyInt *r = int_operand(other)) {
+        if (!isBig && !r->isBig) {
+            return value < r->value;
+        }
+        return compare(to_big(), r->to_big()) < 0;
+    }
+    if (other.kind() == Kind::Float) {
+        double b = static_cast<const PyFloat&>(other).get();
+        return !std::isnan(b) && compare_int_float(*this, b) < 0;
+    }
+    throw UnorderableError(kind(), other.kind());
+}
+
+inline std::type_index PyInt::type() const {
+    return typeid(PyInt);
+}
+
+inline std::string PyInt::repr() const {
+    return isBig ? big->to_string() : std::to_string(value);
+}
+
+inline int64_t PyInt::get() const {
+    if (isBig) {
+        return big->is_negative() ? INT64_MIN : INT64_MAX;
+    }
+    return value;
+}
+
+inline BigInt PyInt::to_big() const {
+    return isBig ? *big : BigInt(value);
+}
+
+inline double PyInt::to_double() const {
+    return isBig ? big->to_double() : static_cast<double>(value);
+}
+
+// -------------------- PyBool --------------------
+inline PyBool::PyBool(bool v) : Object(KIND), value(v) {}
+
+inline ObjectPtr PyBool::__add__(ObjectPtr right) {
+    int a = value ? 1 : 0;
+    switch (right->kind()) {
+        case Kind::Bool:  return py_int(a + static_cast<PyBool&>(*right).get());
+        case Kind::Int:   return int_arith('+', *int_operand(*this), static_cast<PyInt&>(*right));
+        case Kind::Float: return make_ref<PyFloat>(a + static_cast<PyFloat&>(*right).get());
+        default: break;
+    }
+    throw RuntimeError("unsupported operand types for +: 'bool' and '" + right->repr() + "'");
+}
+
+inline ObjectPtr PyBool::__sub__(ObjectPtr right) {
+    int a = value ? 1 : 0;
+    switch (right->kind()) {
+        case Kind::Bool:  return py_int(a - static_cast<PyBool&>(*right).get());
+        case Kind::Int:   return int_arith('-', *int_operand(*this), static_cast<PyInt&>(*right));
+        case Kind::Float: return make_ref<PyFloat>(a - static_cast<PyFloat&>(*right).get());
+        default: break;
+    }
+    throw RuntimeError("unsupported operand types for -: 'bool' and '" + right->repr() + "'");
+}
+
+inline ObjectPtr PyBool::__mul__(ObjectPtr right) {
+    int a = value ? 1 : 0;
+    switch (right->kind()) {
+        case Kind::Bool:  return py_int(a * static_cast<PyBool&>(*right).get());
+        case Kind::Int:   return int_arith('*', *int_operand(*this), static_cast<PyInt&>(*right));
+        case Kind::Float: return make_ref<PyFloat>(a * static_cast<PyFloat&>(*right).get());
+        case Kind::String:
+            // bool * str → строка 0 или 1 раз
+            return make_ref<PyString>(a ? static_cast<PyString&>(*right).get() : std::string());
+        case Kind::List:
+            return a ? make_ref<PyList>(static_cast<PyList&>(*right).buffer())
+                     : make_ref<PyList>(std::vector<ObjectPtr>{});
+        default: break;
+    }
+    throw RuntimeError("unsupported operand types for *: 'bool' and '" + right->repr() + "'");
+}
+
+inline ObjectPtr PyBool::__div__(ObjectPtr right) {
+    double a = value ? 1.0 : 0.0;
+    double b;
+    switch (right->kind()) {
+        case Kind::Bool:  b = static_cast<PyBool&>(*right).get() ? 1.0 : 0.0; break;
+        case Kind::Int:   b = static_cast<PyInt&>(*right).to_double(); break;
+        case Kind::Float: b = static_cast<PyFloat&>(*right).get(); break;
+        default:
+            throw RuntimeError("unsupported operand types for /: 'bool' and '" + right->repr() + "'");
+    }
+    if (b == 0.0) {
+        throw RuntimeError("ZeroDivisionError: division by zero");
+    }
+    return make_ref<PyFloat>(a / b);
+}
+
+// bool сравнивается и хешируется как int 0 или 1 (как в Python): True и 1 —
+// один ключ словаря, True == 1.0, True < 2
+inline std::size_t PyBool::__hash__() const {
+    return py_int(value ? 1 : 0)->__hash__();
+}
+
+inline bool PyBool::__eq__(const Object &other) const {
+    if (other.kind() == Kind::Bool) {
+        return value == static_cast<const PyBool&>(other).value;
+    }
+    return int_operand(*this)->__eq__(other);
+}
+
+inline bool PyBool::__lt__(const Object &other) const {
+    switch (other.kind()) {
+        case Kind::Bool:
+        case Kind::Int:
+        case Kind::Float: return int_operand(*this)->__lt__(other);
+        default:          throw UnorderableError(kind(), other.kind());
+    }
+}
+
+inline std::type_index PyBool::type() const {
+    return typeid(PyBool);
+}
+
+inline std::string PyBool::repr() const {
+    return value ? "True" : "False";
+}
+
+inline bool PyBool::get() const {
+    return value;
+}
+
+// -------------------- PyFloat --------------------
+inline PyFloat::PyFloat(double v) : Object(KIND), value(v) {}
+
+inline ObjectPtr PyFloat::__add__(ObjectPtr right) {
+    double b;
+    if (float_operand(*right, b)) {
+        return make_ref<PyFloat>(value + b);
+    }
+    throw RuntimeError("unsupported operand types for +: 'float' and '" + right->repr() + "'");
+}
+
+inline ObjectPtr PyFloat::__sub__(ObjectPtr right) {
+    double b;
+    if (float_operand(*right, b)) {
+        return make_ref<PyFloat>(value - b);
+    }
+    throw RuntimeError("unsupported operand types for -: 'float' and '" + right->repr() + "'");
+}
+
+inline ObjectPtr PyFloat::__mul__(ObjectPtr right) {
+    double b;
+    if (float_operand(*right, b)) {
+        return make_ref<PyFloat>(value * b);
     }
     throw RuntimeError("unsupported operand types for *: 'float' and '" + right->repr() + "'");
 }
 
 inline ObjectPtr PyFloat::__div__(ObjectPtr right) {
     double b;
-    if (auto r = std::dynamic_pointer_cast<PyFloat>(right)) {
-        b = r->get();
-    } else if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        b = r->get();
-    } else if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        b = r->get() ? 1.0 : 0.0;
-    } else {
+    if (!float_operand(*right, b)) {
         throw RuntimeError("unsupported operand types for /: 'float' and '" + right->repr() + "'");
     }
     if (b == 0.0) {
         throw RuntimeError("ZeroDivisionError: division by zero");
     }
-    return std::make_shared<PyFloat>(value / b);
+    return make_ref<PyFloat>(value / b);
+}
+
+inline std::size_t PyFloat::__hash__() const {
+    double whole;
+    if (std::modf(value, &whole) == 0.0 && whole >= -9223372036854775808.0 && whole < 9223372036854775808.0) {
+        return std::hash<long long>{}(static_cast<long long>(whole));
+    }
+    return std::hash<double>{}(value);
+}
+
+inline bool PyFloat::__eq__(const Object &other) const {
+    switch (other.kind()) {
+        case Kind::Float: return value == static_cast<const PyFloat&>(other).value;
+        case Kind::Int:
+        case Kind::Bool:  return !std::isnan(value) && compare_int_float(*int_operand(other), value) == 0;
+        default:          return false;
+    }
+}
+
+inline bool PyFloat::__lt__(const Object &other) const {
+    if (other.kind() == Kind::Float) {
+        return value < static_cast<const PyFloat&>(other).value;
+    }
+    if (const PyInt *r = int_operand(other)) {
+        return !std::isnan(value) && compare_int_float(*r, value) > 0;
+    }
+    throw UnorderableError(kind(), other.kind());
 }
 
 inline std::type_index PyFloat::type() const {
@@ -608,54 +1656,148 @@ inline double PyFloat::get() const {
 }
 
 // -------------------- PyString --------------------
-inline PyString::PyString(std::string v) : value(std::move(v)) {}
+inline PyString::PyString(std::string v) : Object(KIND), value(std::move(v)), length(value.size()) {}
+
+inline PyString::PyString(Ref<PyString> l, Ref<PyString> r)
+    : Object(KIND), left(std::move(l)), right(std::move(r)), length(left->length + right->length) {}
+
+inline PyString::~PyString() {
+    release_halves();
+}
+
+inline void PyString::release_halves() const {
+    // Верёвка из s = s + piece — цепочка глубиной в число итераций; обычное
+    // разрушение ушло бы в рекурсию такой же глубины. Разбираем её сами:
+    // узел, на который больше никто не ссылается, отдаёт половины в стек.
+    std::vector<Ref<PyString>> pending;
+    if (left) pending.push_back(std::move(left));
+    if (right) pending.push_back(std::move(right));
+    while (!pending.empty()) {
+        Ref<PyString> node = std::move(pending.back());
+        pending.pop_back();
+        if (node->refcount() == 1) {
+            if (node->left) pending.push_back(std::move(node->left));
+            if (node->right) pending.push_back(std::move(node->right));
+        }
+    }
+}
+
+inline void PyString::flatten() const {
+    if (!left) {
+        return;
+    }
+    // s = s + piece с чтением s[i] в цикле склеивает на каждой итерации.
+    // Крайний левый лист — прошлый склеенный текст; если им владеет только
+    // эта верёвка (вся левая цепочка со счётчиком 1), его буфер забираем и
+    // дописываем в него: reserve растит ёмкость в разы, и склейка обходится
+    // амортизированно в длину piece, а не всего текста. Опустевший лист
+    // при обходе ничего не добавляет и уходит вместе с половинами.
+    std::string out;
+    const PyString *leaf = left.get();
+    bool owned = leaf->refcount() == 1;
+    while (owned && leaf->left) {
+        leaf = leaf->left.get();
+        owned = leaf->refcount() == 1;
+    }
+    if (owned) {
+        out = std::move(leaf->value);
+    }
+    out.reserve(length);
+    // Обход листьев слева направо без рекурсии
+    std::vector<const PyString*> stack{this};
+    while (!stack.empty()) {
+        const PyString *node = stack.back();
+        stack.pop_back();
+        if (node->left) {
+            stack.push_back(node->right.get());
+            stack.push_back(node->left.get());
+        } else {
+            out += node->value;
+        }
+    }
+    value = std::move(out);
+    release_halves();
+}
 
 inline ObjectPtr PyString::__add__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyString>(right)) {
-        return std::make_shared<PyString>(value + r->value);
+    if (auto r = kind_cast<PyString>(right)) {
+        if (length + r->length < ROPE_MIN) {
+            return make_ref<PyString>(get() + r->get());
+        }
+        return make_ref<PyString>(Ref<PyString>(this), Ref<PyString>(r));
     }
     throw RuntimeError("unsupported operand types for +: 'str' and '" + right->repr() + "'");
 }
 
 inline ObjectPtr PyString::__mul__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        int times = r->get();
-        if (times < 0) times = 0;
-        std::string accum;
-        for (int i = 0; i < times; ++i) {
-            accum += value;
-        }
-        return std::make_shared<PyString>(accum);
+    const PyInt *r = int_operand(*right);
+    if (!r) {
+        throw RuntimeError("unsupported operand types for *: 'str' and '" + right->repr() + "'");
     }
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        int times = r->get() ? 1 : 0;
-        std::string accum;
-        for (int i = 0; i < times; ++i) {
-            accum += value;
+    std::size_t times = repeat_count(*r, length, std::string().max_size(), "string");
+    std::string accum;
+    if (times > 0) {
+        const std::string &text = get();
+        try {
+            accum.reserve(text.size() * times);
+        } catch (const std::bad_alloc &) {
+            throw RuntimeError("MemoryError: repeated string is too long");
+        }
+        for (std::size_t i = 0; i < times; ++i) {
+            accum += text;
         }
-        return std::make_shared<PyString>(accum);
     }
-    throw RuntimeError("unsupported operand types for *: 'str' and '" + right->repr() + "'");
+    return make_ref<PyString>(std::move(accum));
 }
 
 inline ObjectPtr PyString::__getitem__(ObjectPtr idx) {
-    auto iobj = std::dynamic_pointer_cast<PyInt>(idx);
+    auto iobj = kind_cast<PyInt>(idx);
     if (!iobj) {
         throw RuntimeError("string indices must be integers");
     }
-    int i = iobj->get();
-    if (i < 0 || i >= int(value.size())) {
+    int64_t i = iobj->get();
+    if (i < 0 || i >= static_cast<int64_t>(length)) {
         throw RuntimeError("string index out of range");
     }
-    return std::make_shared<PyString>(std::string(1, value[i]));
+    return py_char(get()[i]);
 }
 
 inline bool PyString::__contains__(ObjectPtr item) {
-    auto sub = std::dynamic_pointer_cast<PyString>(item);
+    auto sub = kind_cast<PyString>(item);
     if (!sub) {
         throw RuntimeError("'in' requires a string as right operand");
     }
-    return value.find(sub->value) != std::string::npos;
+    return get().find(sub->get()) != std::string::npos;
+}
+
+inline std::size_t PyString::__hash__() const {
+    if (!hashed) {
+        cachedHash = std::hash<std::string>{}(get());
+        hashed = true;
+    }
+    return cachedHash;
+}
+
+inline bool PyString::__eq__(const Object &other) const {
+    if (this == &other) {
+        return true;
+    }
+    if (other.kind() != Kind::String) {
+        return false;
+    }
+    const auto &str = static_cast<const PyString&>(other);
+    // Для каждого текста есть только одна интернированная строка
+    if (interned && str.interned) {
+        return false;
+    }
+    return length == str.length && __hash__() == str.__hash__() && get() == str.get();
+}
+
+inline bool PyString::__lt__(const Object &other) const {
+    if (other.kind() != Kind::String) {
+        throw UnorderableError(kind(), other.kind());
+    }
+    return get() < static_cast<const PyString&>(other).get();
 }
 
 inline std::type_index PyString::type() const {
@@ -663,127 +1805,623 @@ inline std::type_index PyString::type() const {
 }
 
 inline std::string PyString::repr() const {
-    return '"' + value + '"';
+    return '"' + get() + '"';
 }
 
 inline const std::string &PyString::get() const {
+    flatten();
     return value;
 }
 
+// Интернирование: одна общая PyString на каждый текст (имена атрибутов,
+// строковые литералы). Такие строки живут до конца программы — таблица держит
+// на них ссылку, а ключом служит их собственный текст, — поэтому две
+// интернированные строки равны тогда и только тогда, когда это один объект.
+inline Ref<PyString> py_intern(std::string_view text) {
+    static std::unordered_map<std::string_view, Ref<PyString>> table;
+    auto it = table.find(text);
+    if (it != table.end()) {
+        return it->second;
+    }
+    auto str = make_ref<PyString>(std::string(text));
+    str->interned = true;
+    str->__hash__();
+    table.emplace(str->value, str);
+    return str;
+}
+
+// Интернированная строка с тем же текстом, что у name (ключ для поиска по адресу)
+inline const PyString *py_intern_key(const PyString &name) {
+    return name.is_interned() ? &name : py_intern(name.get()).get();
+}
+
+// Строки из одного символа (итерация по строке, s[i]) берутся из готовой
+// таблицы на все 256 байт, а не создаются заново. Они же интернированы,
+// так что сравнение с литералом "a" — сравнение адресов.
+inline const Ref<PyString> &py_char(char c) {
+    static const std::array<Ref<PyString>, 256> table = [] {
+        std::array<Ref<PyString>, 256> chars;
+        for (int i = 0; i < 256; ++i) {
+            chars[i] = py_intern(std::string(1, static_cast<char>(i)));
+        }
+        return chars;
+    }();
+    return table[static_cast<unsigned char>(c)];
+}
+
+// -------------------- Object: атрибуты по умолчанию --------------------
+// (здесь, потому что нужен полный PyString)
+inline void Object::__setattr__(const Ref<PyString> &name, ObjectPtr value) {
+    throw RuntimeError("object has no attribute '" + name->get() + "'");
+}
+
+inline ObjectPtr Object::__getattr__(const Ref<PyString> &name) {
+    throw RuntimeError("object has no attribute '" + name->get() + "'");
+}
+
+// -------------------- ListBuffer --------------------
+inline ListBuffer::ListBuffer(std::vector<ObjectPtr> v) {
+    if (v.empty()) {
+        return;
+    }
+    Strategy s = strategy_of(*v[0]);
+    for (std::size_t i = 1; i < v.size() && s != Strategy::Object; ++i) {
+        if (strategy_of(*v[i]) != s) {
+            s = Strategy::Object;
+        }
+    }
+    strat = s;
+    if (s == Strategy::Object) {
+        containers = std::any_of(v.begin(), v.end(), [](const ObjectPtr &el) { return el->gc_container(); });
+        items = std::move(v);
+        return;
+    }
+    words.reserve(v.size());
+    for (const auto &el : v) {
+        words.push_back(word_of(s, *el));
+    }
+}
+
+inline ListBuffer::Strategy ListBuffer::strategy_of(const Object &value) {
+    switch (value.kind()) {
+        // Длинное целое в слово не помещается
+        case Kind::Int:   return static_cast<const PyInt&>(value).is_small() ? Strategy::Int : Strategy::Object;
+        case Kind::Float: return Strategy::Float;
+        case Kind::Bool:  return Strategy::Bool;
+        default:          return Strategy::Object;
+    }
+}
+
+inline uint64_t ListBuffer::word_of(Strategy s, const Object &value) {
+    switch (s) {
+        case Strategy::Int:   return std::bit_cast<uint64_t>(static_cast<const PyInt&>(value).get());
+        case Strategy::Float: return std::bit_cast<uint64_t>(static_cast<const PyFloat&>(value).get());
+        default:              return static_cast<const PyBool&>(value).get() ? 1 : 0;
+    }
+}
+
+inline ObjectPtr ListBuffer::box(Strategy s, uint64_t word) {
+    switch (s) {
+        case Strategy::Int:   return py_int(std::bit_cast<int64_t>(word));
+        case Strategy::Float: return make_ref<PyFloat>(std::bit_cast<double>(word));
+        default:              return py_bool(word != 0);
+    }
+}
+
+inline void ListBuffer::reserve(std::size_t n) {
+    if (strat == Strategy::Object) {
+        items.reserve(n);
+    } else {
+        words.reserve(n);
+    }
+}
+
+inline ObjectPtr ListBuffer::get(std::size_t i) const {
+    return strat == Strategy::Object ? items[i] : box(strat, words[i]);
+}
+
+inline void ListBuffer::set(std::size_t i, ObjectPtr value) {
+    if (strat != Strategy::Object) {
+        if (strategy_of(*value) == strat) {
+            words[i] = word_of(strat, *value);
+            return;
+        }
+        generalize();
+    }
+    containers |= value->gc_container();
+    items[i] = std::move(value);
+}
+
+inline void ListBuffer::push_back(ObjectPtr value) {
+    if (strat == Strategy::Empty) {
+        strat = strategy_of(*value);
+    }
+    if (strat != Strategy::Object) {
+        if (strategy_of(*value) == strat) {
+            words.push_back(word_of(strat, *value));
+            return;
+        }
+        generalize();
+    }
+    containers |= value->gc_container();
+    items.push_back(std::move(value));
+}
+
+inline void ListBuffer::push_word(Strategy s, uint64_t word) {
+    if (strat == Strategy::Empty) {
+        strat = s;
+    }
+    if (strat == s) {
+        words.push_back(word);
+        return;
+    }
+    if (strat != Strategy::Object) {
+        generalize();
+    }
+    items.push_back(box(s, word));
+}
+
+inline void ListBuffer::extend(const ListBuffer &other) {
+    containers |= other.containers;
+    if (strat == Strategy::Empty) {
+        strat = other.strat;
+    }
+    if (strat == other.strat) {
+        if (strat == Strategy::Object) {
+            items.insert(items.end(), other.items.begin(), other.items.end());
+        } else {
+            words.insert(words.end(), other.words.begin(), other.words.end());
+        }
+        return;
+    }
+    if (other.strat == Strategy::Empty) {
+        return;
+    }
+    if (strat != Strategy::Object) {
+        generalize();
+    }
+    items.reserve(items.size() + other.size());
+    for (std::size_t i = 0; i < other.size(); ++i) {
+        items.push_back(other.get(i));
+    }
+}
+
+inline std::vector<ObjectPtr> ListBuffer::objects() const {
+    if (strat == Strategy::Object) {
+        return items;
+    }
+    std::vector<ObjectPtr> result;
+    result.reserve(words.size());
+    for (uint64_t w : words) {
+        result.push_back(box(strat, w));
+    }
+    return result;
+}
+
+inline void ListBuffer::gc_traverse(GcObject::Visit visit, void *ctx) const {
+    for (const auto &el : items) {
+        visit(el.get(), ctx);
+    }
+}
+
+inline void ListBuffer::clear() {
+    strat = Strategy::Empty;
+    containers = false;
+    words.clear();
+    items.clear();
+}
+
+inline void ListBuffer::generalize() {
+    items.reserve(words.capacity());
+    for (uint64_t w : words) {
+        items.push_back(box(strat, w));
+    }
+    words.clear();
+    words.shrink_to_fit();
+    strat = Strategy::Object;
+}
+
 // -------------------- PyList --------------------
-inline PyList::PyList(std::vector<ObjectPtr> v) : elems(std::move(v)) {}
+inline PyList::PyList(std::vector<ObjectPtr> v)
+    : PyList(make_ref<ListBuffer>(std::move(v))) {}
+
+inline PyList::PyList(Ref<ListBuffer> shared) : GcObject(KIND, false), buf(std::move(shared)) {
+    if (buf->has_containers()) {
+        gc_track();
+    }
+}
+
+inline ListBuffer &PyList::buffer_for_write() {
+    if (buf->refcount() > 1) {
+        buf = make_ref<ListBuffer>(*buf);
+    }
+    return *buf;
+}
+
+// Общий буфер (копии, снимки обхода) считается внешней ссылкой: чей он —
+// неизвестно, а лишняя вычтенная ссылка сделала бы живой объект мусором
+inline void PyList::gc_traverse(Visit visit, void *ctx) const {
+    if (buf->refcount() == 1) {
+        buf->gc_traverse(visit, ctx);
+    }
+}
+
+inline void PyList::gc_clear() {
+    if (buf->refcount() == 1) {
+        buf->clear();
+    }
+}
 
 inline ObjectPtr PyList::__add__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyList>(right)) {
-        std::vector<ObjectPtr> merged = elems;
-        merged.insert(merged.end(), r->elems.begin(), r->elems.end());
-        return std::make_shared<PyList>(std::move(merged));
+    if (auto r = kind_cast<PyList>(right)) {
+        // С пустым списком результат равен другому операнду — делим его буфер
+        if (r->buf->empty()) {
+            return make_ref<PyList>(buf);
+        }
+        if (buf->empty()) {
+            return make_ref<PyList>(r->buf);
+        }
+        auto merged = make_ref<ListBuffer>();
+        merged->reserve(buf->size() + r->buf->size());
+        merged->extend(*buf);
+        merged->extend(*r->buf);
+        return make_ref<PyList>(std::move(merged));
     }
     throw RuntimeError("can only concatenate list (not '" + right->repr() + "') to list");
 }
 
 inline ObjectPtr PyList::__mul__(ObjectPtr right) {
-    if (auto r = std::dynamic_pointer_cast<PyInt>(right)) {
-        int times = r->get();
-        if (times < 0) times = 0;
-        std::vector<ObjectPtr> accum;
-        for (int i = 0; i < times; ++i) {
-            for (auto &el : elems) {
-                accum.push_back(el);
-            }
-        }
-        return std::make_shared<PyList>(std::move(accum));
+    const PyInt *r = int_operand(*right);
+    if (!r) {
+        throw RuntimeError("unsupported operand types for *: 'list' and '" + right->repr() + "'");
     }
-    if (auto r = std::dynamic_pointer_cast<PyBool>(right)) {
-        int times = r->get() ? 1 : 0;
-        std::vector<ObjectPtr> accum;
-        for (int i = 0; i < times; ++i) {
-            for (auto &el : elems) {
-                accum.push_back(el);
-            }
+    std::size_t times = repeat_count(*r, buf->size(), std::vector<ObjectPtr>().max_size(), "list");
+    if (times == 1) {
+        return make_ref<PyList>(buf);
+    }
+    auto accum = make_ref<ListBuffer>();
+    if (times > 0) {
+        // Сначала стратегия (extend пустого буфера её перенимает), потом место под всё
+        accum->extend(*buf);
+        try {
+            accum->reserve(buf->size() * times);
+        } catch (const std::bad_alloc &) {
+            throw RuntimeError("MemoryError: repeated list is too long");
+        }
+        for (std::size_t i = 1; i < times; ++i) {
+            accum->extend(*buf);
         }
-        return std::make_shared<PyList>(std::move(accum));
     }
-    throw RuntimeError("unsupported operand types for *: 'list' and '" + right->repr() + "'");
+    return make_ref<PyList>(std::move(accum));
 }
 
 inline ObjectPtr PyList::__getitem__(ObjectPtr idx) {
-    auto iobj = std::dynamic_pointer_cast<PyInt>(idx);
+    auto iobj = kind_cast<PyInt>(idx);
     if (!iobj) {
         throw RuntimeError("list indices must be integers");
     }
-    int i = iobj->get();
-    if (i < 0 || i >= int(elems.size())) {
+    int64_t i = iobj->get();
+    if (i < 0 || i >= static_cast<int64_t>(buf->size())) {
         throw RuntimeError("list index out of range");
     }
-    return elems[i];
+    return buf->get(i);
 }
 
 inline void PyList::__setitem__(ObjectPtr idx, ObjectPtr value) {
-    auto iobj = std::dynamic_pointer_cast<PyInt>(idx);
+    auto iobj = kind_cast<PyInt>(idx);
     if (!iobj) {
         throw RuntimeError("list indices must be integers");
     }
-    int i = iobj->get();
-    if (i < 0 || i >= static_cast<int>(elems.size())) {
+    int64_t i = iobj->get();
+    if (i < 0 || i >= static_cast<int64_t>(buf->size())) {
         throw RuntimeError("list index out of range");
     }
-    elems[i] = value;
+    gc_write_barrier(*value);
+    buffer_for_write().set(i, std::move(value));
 }
 
 inline bool PyList::__contains__(ObjectPtr item) {
-    for (auto &el : elems) {
-        if (el->repr() == item->repr()) return true;
+    const ListBuffer &b = *buf;
+    // Короткое целое в списке целых ищем среди слов, без упаковки
+    if (b.strategy() == ListBuffer::Strategy::Int && ListBuffer::strategy_of(*item) == ListBuffer::Strategy::Int) {
+        uint64_t w = ListBuffer::word_of(ListBuffer::Strategy::Int, *item);
+        for (std::size_t i = 0; i < b.size(); ++i) {
+            if (b.word(i) == w) return true;
+        }
+        return false;
+    }
+    for (std::size_t i = 0; i < b.size(); ++i) {
+        ObjectPtr el = b.get(i);
+        if (el == item || el->__eq__(*item)) return true;
     }
     return false;
 }
 
+inline bool PyList::__eq__(const Object &other) const {
+    if (other.kind() != Kind::List) {
+        return false;
+    }
+    const ListBuffer &l = *buf;
+    const ListBuffer &r = *static_cast<const PyList&>(other).buf;
+    if (&l == &r) {
+        return true;
+    }
+    if (l.size() != r.size()) {
+        return false;
+    }
+    using Strategy = ListBuffer::Strategy;
+    // Целые и bool одной стратегии равны, когда равны слова
+    if (l.strategy() == r.strategy() && (l.strategy() == Strategy::Int || l.strategy() == Strategy::Bool)) {
+        for (std::size_t i = 0; i < l.size(); ++i) {
+            if (l.word(i) != r.word(i)) return false;
+        }
+        return true;
+    }
+    for (std::size_t i = 0; i < l.size(); ++i) {
+        ObjectPtr a = l.get(i);
+        ObjectPtr b = r.get(i);
+        if (a != b && !a->__eq__(*b)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool PyList::__lt__(const Object &other) const {
+    if (other.kind() != Kind::List) {
+        throw UnorderableError(kind(), other.kind());
+    }
+    // Первая несовпадающая пара решает; если одна — префикс другой, меньше короткая
+    const ListBuffer &l = *buf;
+    const ListBuffer &r = *static_cast<const PyList&>(other).buf;
+    std::size_t n = std::min(l.size(), r.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        ObjectPtr a = l.get(i);
+        ObjectPtr b = r.get(i);
+        if (a != b && !a->__eq__(*b)) {
+            return a->__lt__(*b);
+        }
+    }
+    return l.size() < r.size();
+}
+
 inline std::type_index PyList::type() const {
     return typeid(PyList);
 }
 
 inline std::string PyList::repr() const {
     std::string s = "[";
-    bool first = true;
-    for (auto &el : elems) {
-        if (!first) s += ", ";
-        s += el->repr();
-        first = false;
+    for (std::size_t i = 0; i < buf->size(); ++i) {
+        if (i) s += ", ";
+        s += buf->get(i)->repr();
     }
     return s + "]";
 }
 
-inline const std::vector<ObjectPtr>& PyList::getElements() const {
-    return elems;
+inline void PyList::append(ObjectPtr value) {
+    gc_write_barrier(*value);
+    buffer_for_write().push_back(std::move(value));
+}
+
+// -------------------- PyTuple --------------------
+inline PyTuple::PyTuple(std::size_t n) : GcObject(KIND, false), count(static_cast<uint32_t>(n)) {
+    std::uninitialized_value_construct_n(items(), n);
+}
+
+inline PyTuple::~PyTuple() {
+    std::destroy_n(items(), count);
+}
+
+inline void *PyTuple::operator new(std::size_t, Elements n) {
+    return Pool::allocate(bytes_for(n.count));
+}
+
+inline void PyTuple::operator delete(void *p, Elements n) {
+    Pool::deallocate(p, bytes_for(n.count));
+}
+
+inline void PyTuple::operator delete(PyTuple *p, std::destroying_delete_t) {
+    std::size_t n = p->count;
+    p->~PyTuple();
+    Pool::deallocate(p, bytes_for(n));
+}
+
+inline Ref<PyTuple> PyTuple::allocate(std::size_t n) {
+    return Ref<PyTuple>(new (Elements{n}) PyTuple(n));
+}
+
+inline Ref<PyTuple> PyTuple::make(std::initializer_list<ObjectPtr> elems) {
+    Ref<PyTuple> t = allocate(elems.size());
+    for (const auto &el : elems) {
+        t->gc_write_barrier(*el);
+    }
+    std::copy(elems.begin(), elems.end(), t->items());
+    return t;
+}
+
+inline Ref<PyTuple> PyTuple::from(const ListBuffer &elems) {
+    Ref<PyTuple> t = allocate(elems.size());
+    for (std::size_t i = 0; i < elems.size(); ++i) {
+        t->items()[i] = elems.get(i);
+    }
+    if (elems.has_containers()) {
+        t->gc_track();
+    }
+    return t;
+}
+
+inline void PyTuple::gc_traverse(Visit visit, void *ctx) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        gc_visit(items()[i], visit, ctx);
+    }
+}
+
+// Неизменяемость нарушается только у мусора, который уже никто не увидит
+inline void PyTuple::gc_clear() {
+    for (std::size_t i = 0; i < count; ++i) {
+        items()[i] = nullptr;
+    }
+}
+
+inline ObjectPtr PyTuple::__add__(ObjectPtr right) {
+    if (auto r = kind_cast<PyTuple>(right)) {
+        if (r->empty()) {
+            return ObjectPtr(this);
+        }
+        if (empty()) {
+            return right;
+        }
+        Ref<PyTuple> t = allocate(count + r->count);
+        std::copy_n(items(), count, t->items());
+        std::copy_n(r->items(), r->count, t->items() + count);
+        if (gc_tracked() || r->gc_tracked()) {
+            t->gc_track();
+        }
+        return t;
+    }
+    throw RuntimeError("can only concatenate tuple (not '" + right->repr() + "') to tuple");
+}
+
+inline ObjectPtr PyTuple::__getitem__(ObjectPtr idx) {
+    auto iobj = kind_cast<PyInt>(idx);
+    if (!iobj) {
+        throw RuntimeError("tuple indices must be integers");
+    }
+    int64_t i = iobj->get();
+    if (i < 0 || i >= static_cast<int64_t>(count)) {
+        throw RuntimeError("tuple index out of range");
+    }
+    return items()[i];
+}
+
+inline bool PyTuple::__contains__(ObjectPtr item) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const ObjectPtr &el = items()[i];
+        if (el == item || el->__eq__(*item)) return true;
+    }
+    return false;
+}
+
+inline std::size_t PyTuple::__hash__() const {
+    // Смешивание хешей элементов, как у tuple в CPython до 3.8
+    std::size_t h = 0x345678;
+    std::size_t mult = 1000003;
+    for (std::size_t i = 0; i < count; ++i) {
+        h = (h ^ items()[i]->__hash__()) * mult;
+        mult += 82520 + 2 * (count - i - 1);
+    }
+    return h + 97531;
+}
+
+inline bool PyTuple::__eq__(const Object &other) const {
+    if (other.kind() != Kind::Tuple) {
+        return false;
+    }
+    const auto &r = static_cast<const PyTuple&>(other);
+    if (count != r.count) {
+        return false;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        const ObjectPtr &a = items()[i];
+        const ObjectPtr &b = r.items()[i];
+        if (a != b && !a->__eq__(*b)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool PyTuple::__lt__(const Object &other) const {
+    if (other.kind() != Kind::Tuple) {
+        throw UnorderableError(kind(), other.kind());
+    }
+    // Как у списка: решает первая несовпадающая пара, иначе меньше короткий
+    const auto &r = static_cast<const PyTuple&>(other);
+    std::size_t n = std::min(count, r.count);
+    for (std::size_t i = 0; i < n; ++i) {
+        const ObjectPtr &a = items()[i];
+        const ObjectPtr &b = r.items()[i];
+        if (a != b && !a->__eq__(*b)) {
+            return a->__lt__(*b);
+        }
+    }
+    return count < r.count;
+}
+
+inline std::type_index PyTuple::type() const {
+    return typeid(PyTuple);
+}
+
+inline std::string PyTuple::repr() const {
+    std::string s = "(";
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i) s += ", ";
+        s += items()[i]->repr();
+    }
+    // Кортеж из одного элемента пишется с запятой: (1,)
+    return s + (count == 1 ? ",)" : ")");
 }
 
 // -------------------- PyDict --------------------
-inline PyDict::PyDict() = default;
+inline PyDict::PyDict() : GcObject(KIND, false) {}
+
+inline void PyDict::gc_traverse(Visit visit, void *ctx) const {
+    for (const auto &kv : items) {
+        gc_visit(kv.first, visit, ctx);
+        gc_visit(kv.second, visit, ctx);
+    }
+}
+
+inline void PyDict::gc_clear() {
+    items.clear();
+    index = HashIndex{};
+}
 
 inline void PyDict::__setitem__(ObjectPtr key, ObjectPtr val) {
-    for (auto &p : items) {
-        if (p.first->repr() == key->repr()) {
-            p.second = val;
-            return;
-        }
+    gc_write_barrier(*key);
+    gc_write_barrier(*val);
+    auto [ix, added] = index.insert(*key, key->__hash__(), items.size(), key_of());
+    if (added) {
+        items.emplace_back(std::move(key), std::move(val));
+    } else {
+        items[ix].second = std::move(val);
+    }
+}
+
+inline ObjectPtr PyDict::get(const Object &key) const {
+    if (items.empty()) {
+        return nullptr;
     }
-    items.emplace_back(key, val);
+    int32_t ix = index.find(key, key.__hash__(), key_of());
+    return ix == HashIndex::EMPTY ? nullptr : items[ix].second;
 }
 
 inline ObjectPtr PyDict::__getitem__(ObjectPtr idx) {
-    for (auto &p : items) {
-        if (p.first->repr() == idx->repr())
-            return p.second;
+    if (ObjectPtr value = get(*idx)) {
+        return value;
     }
     throw RuntimeError("KeyError: " + idx->repr());
 }
 
 inline bool PyDict::__contains__(ObjectPtr idx) {
-    for (auto &p : items) {
-        if (p.first->repr() == idx->repr())
-            return true;
+    return get(*idx) != nullptr;
+}
+
+inline bool PyDict::__eq__(const Object &other) const {
+    if (other.kind() != Kind::Dict) {
+        return false;
     }
-    return false;
+    const auto &r = static_cast<const PyDict&>(other);
+    if (items.size() != r.items.size()) {
+        return false;
+    }
+    for (auto &[key, val] : items) {
+        ObjectPtr rval = r.get(*key);
+        if (!rval || (rval != val && !val->__eq__(*rval))) {
+            return false;
+        }
+    }
+    return true;
 }
 
 inline std::type_index PyDict::type() const {
@@ -806,38 +2444,130 @@ inline const std::vector<std::pair<ObjectPtr,ObjectPtr>>& PyDict::getItems() con
 }
 
 // -------------------- PySet --------------------
-inline PySet::PySet() = default;
+inline void PySet::gc_traverse(Visit visit, void *ctx) const {
+    for (const auto &el : elems) {
+        gc_visit(el, visit, ctx);
+    }
+}
 
-inline PySet::PySet(std::vector<ObjectPtr> v) {
+inline void PySet::gc_clear() {
+    elems.clear();
+    index = HashIndex{};
+}
+
+inline PySet::PySet() : GcObject(KIND, false) {}
+
+inline PySet::PySet(std::vector<ObjectPtr> v) : GcObject(KIND, false) {
+    elems.reserve(v.size());
+    index.reserve(v.size());
     for (auto &e : v) {
         if (!e) {
         throw RuntimeError("internal error: null element in set constructor");
         }
-        if (!__contains__(e))
-            elems.push_back(e);
+        add(std::move(e));
     }
 }
 
+inline void PySet::add(ObjectPtr item) {
+    if (index.insert(*item, item->__hash__(), elems.size(), key_of()).second) {
+        gc_write_barrier(*item);
+        elems.push_back(std::move(item));
+    }
+}
+
+inline bool PySet::has(const Object &item) const {
+    return !elems.empty()
+        && index.find(item, item.__hash__(), key_of()) != HashIndex::EMPTY;
+}
+
 inline ObjectPtr PySet::__add__(ObjectPtr right) {
-    auto r = std::dynamic_pointer_cast<PySet>(right);
+    return __or__(std::move(right));
+}
+
+inline ObjectPtr PySet::__or__(ObjectPtr right) {
+    auto *r = kind_cast<PySet>(right);
     if (!r) {
         throw RuntimeError("unsupported operand for set union");
     }
-    auto result = std::make_shared<PySet>(elems);
+    // Копия левого множества вместе с индексом (без перехеширования),
+    // затем досыпаем элементы правого
+    auto result = make_ref<PySet>();
+    result->elems = elems;
+    result->index = index;
+    for (auto &e : r->elems) {
+        result->add(e);
+    }
+    return result;
+}
+
+inline ObjectPtr PySet::__and__(ObjectPtr right) {
+    auto *r = kind_cast<PySet>(right);
+    if (!r) {
+        throw RuntimeError("unsupported operand for set intersection");
+    }
+    // Обходим меньшее множество, проверяем принадлежность большему
+    const PySet &small = elems.size() <= r->elems.size() ? *this : *r;
+    const PySet &large = &small == this ? *r : *this;
+    auto result = make_ref<PySet>();
+    for (auto &e : small.elems) {
+        if (large.has(*e)) {
+            result->add(e);
+        }
+    }
+    return result;
+}
+
+inline ObjectPtr PySet::__sub__(ObjectPtr right) {
+    auto *r = kind_cast<PySet>(right);
+    if (!r) {
+        throw RuntimeError("unsupported operand for set difference");
+    }
+    auto result = make_ref<PySet>();
+    for (auto &e : elems) {
+        if (!r->has(*e)) {
+            result->add(e);
+        }
+    }
+    return result;
+}
+
+inline ObjectPtr PySet::__xor__(ObjectPtr right) {
+    auto *r = kind_cast<PySet>(right);
+    if (!r) {
+        throw RuntimeError("unsupported operand for set symmetric difference");
+    }
+    auto result = make_ref<PySet>();
+    for (auto &e : elems) {
+        if (!r->has(*e)) {
+            result->add(e);
+        }
+    }
     for (auto &e : r->elems) {
-        if (!result->__contains__(e)) {
-            result->elems.push_back(e);
+        if (!has(*e)) {
+            result->add(e);
         }
     }
     return result;
 }
 
 inline bool PySet::__contains__(ObjectPtr item) {
+    return has(*item);
+}
+
+inline bool PySet::__eq__(const Object &other) const {
+    if (other.kind() != Kind::Set) {
+        return false;
+    }
+    const auto &r = static_cast<const PySet&>(other);
+    if (elems.size() != r.elems.size()) {
+        return false;
+    }
     for (auto &e : elems) {
-        if (e->repr() == item->repr())
-            return true;
+        if (!r.has(*e)) {
+            return false;
+        }
     }
-    return false;
+    return true;
 }
 
 inline std::type_index PySet::type() const {
@@ -863,7 +2593,7 @@ inline const std::vector<ObjectPtr>& PySet::getElements() const {
 inline PyBuiltinFunction::PyBuiltinFunction(
     std::string name,
     std::function<ObjectPtr(const std::vector<ObjectPtr>&)> fn
-) : name(std::move(name)), fn(std::move(fn)) {}
+) : Object(KIND), name(std::move(name)), fn(std::move(fn)) {}
 
 inline ObjectPtr PyBuiltinFunction::__call__(const std::vector<ObjectPtr> &args) {
     return fn(args);
@@ -877,29 +2607,212 @@ inline std::string PyBuiltinFunction::repr() const {
     return "<built-in function " + name + ">";
 }
 
+// -------------------- PyString: методы --------------------
+// (здесь, потому что нужен полный PyBuiltinFunction)
+
+// sep.join(parts): длина результата считается заранее, текст копируется один раз
+inline ObjectPtr py_str_join(const PyString &sep, const std::vector<ObjectPtr> &parts) {
+    std::size_t total = parts.empty() ? 0 : sep.size() * (parts.size() - 1);
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        auto *part = kind_cast<PyString>(parts[i]);
+        if (!part) {
+            throw RuntimeError("TypeError: sequence item " + std::to_string(i)
+                + ": expected str instance");
+        }
+        total += part->size();
+    }
+    std::string out;
+    out.reserve(total);
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        if (i > 0) {
+            out += sep.get();
+        }
+        out += static_cast<const PyString&>(*parts[i]).get();
+    }
+    return make_ref<PyString>(std::move(out));
+}
+
+inline ObjectPtr PyString::__getattr__(const Ref<PyString> &name) {
+    static const Ref<PyString> joinName = py_intern("join");
+    if (!name->__eq__(*joinName)) {
+        return Object::__getattr__(name);
+    }
+    Ref<PyString> self(this);
+    return make_ref<PyBuiltinFunction>("join", [self](const std::vector<ObjectPtr> &args) -> ObjectPtr {
+        if (args.size() != 1) {
+            throw RuntimeError("TypeError: join() takes exactly one argument ("
+                + std::to_string(args.size()) + " given)");
+        }
+        switch (args[0]->kind()) {
+            case Kind::List:
+                return py_str_join(*self, static_cast<PyList&>(*args[0]).elements());
+            case Kind::Tuple: {
+                const auto &tuple = static_cast<PyTuple&>(*args[0]);
+                std::vector<ObjectPtr> parts(tuple.size());
+                for (std::size_t i = 0; i < tuple.size(); ++i) {
+                    parts[i] = tuple.item(i);
+                }
+                return py_str_join(*self, parts);
+            }
+            case Kind::Set:
+                return py_str_join(*self, static_cast<PySet&>(*args[0]).getElements());
+            case Kind::String: {
+                std::vector<ObjectPtr> chars;
+                for (char c : static_cast<PyString&>(*args[0]).get()) {
+                    chars.push_back(py_char(c));
+                }
+                return py_str_join(*self, chars);
+            }
+            default:
+                throw RuntimeError("TypeError: can only join an iterable");
+        }
+    });
+}
+
+
+// -------------------- PyInstance --------------------
+// -------------------- Shape --------------------
+inline const Ref<Shape> &Shape::root() {
+    static const Ref<Shape> empty(new Shape());
+    return empty;
+}
+
+inline int Shape::slot_of(const PyString *name) const {
+    // Атрибутов у экземпляра обычно единицы — линейный поиск по адресам
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+inline const Ref<Shape> &Shape::with(const PyString *name) {
+    for (auto &[key, next] : transitions) {
+        if (key == name) {
+            return next;
+        }
+    }
+    Ref<Shape> next(new Shape());
+    next->names = names;
+    next->names.push_back(name);
+    transitions.emplace_back(name, std::move(next));
+    return transitions.back().second;
+}
 
 // -------------------- PyInstance --------------------
-inline PyInstance::PyInstance(std::shared_ptr<PyClass> cls)
-    : classPtr(std::move(cls)), instanceDict(std::make_shared<PyDict>())
-{}
+inline PyInstance::PyInstance(Ref<PyClass> cls, Ref<Shape> initial, bool inlineValues)
+    : GcObject(KIND), classPtr(std::move(cls)), shape(std::move(initial)), values(nullptr)
+{
+    std::size_t count = shape->size();
+    if (inlineValues) {
+        values = inline_values();
+    } else if (count > 0) {
+        values = static_cast<ObjectPtr*>(Pool::allocate(capacity_for(count) * sizeof(ObjectPtr)));
+    }
+    std::uninitialized_value_construct_n(values, count);
+}
 
-inline ObjectPtr PyInstance::__getattr__(const std::string &name) {
-    auto key = std::make_shared<PyString>(name);
-    if (instanceDict->__contains__(key)) {
-        return instanceDict->__getitem__(key);
+inline Ref<PyInstance> PyInstance::create(Ref<PyClass> cls) {
+    Ref<Shape> initial = cls->instance_shape();
+    if (cls->fixed_layout() && initial->size() > 0) {
+        InlineSlots extra{initial->size()};
+        return Ref<PyInstance>(new (extra) PyInstance(std::move(cls), std::move(initial), true));
+    }
+    return Ref<PyInstance>(new PyInstance(std::move(cls), std::move(initial), false));
+}
+
+inline PyInstance::~PyInstance() {
+    std::destroy_n(values, shape->size());
+    if (values != inline_values() && values) {
+        Pool::deallocate(values, capacity_for(shape->size()) * sizeof(ObjectPtr));
+    }
+}
+
+// У экземпляра со значениями за объектом форма не меняется (__slots__),
+// поэтому их число до разрушения — то же, что при выделении
+inline void PyInstance::operator delete(PyInstance *p, std::destroying_delete_t) {
+    std::size_t extra = p->values == p->inline_values() ? p->shape->size() : 0;
+    p->~PyInstance();
+    Pool::deallocate(p, sizeof(PyInstance) + extra * sizeof(ObjectPtr));
+}
+
+inline void PyInstance::gc_traverse(Visit visit, void *ctx) const {
+    gc_visit(classPtr, visit, ctx);
+    for (std::size_t i = 0; i < shape->size(); ++i) {
+        gc_visit(values[i], visit, ctx);
+    }
+}
+
+// Класс остаётся: ссылки класса на экземпляр (если были) рвёт его собственный gc_clear
+inline void PyInstance::gc_clear() {
+    for (std::size_t i = 0; i < shape->size(); ++i) {
+        values[i] = nullptr;
+    }
+}
+
+// Ёмкость отдельного массива значений: степень двойки, не меньше 4
+inline std::size_t PyInstance::capacity_for(std::size_t count) {
+    return count == 0 ? 0 : std::max<std::size_t>(4, std::bit_ceil(count));
+}
+
+inline ObjectPtr *PyInstance::slot_for(const PyString &name, AttrCache &cache) {
+    if (shape->id == cache.shape) {
+        return cache.slot == AttrCache::NO_SLOT ? nullptr : &values[cache.slot];
+    }
+    int slot = shape->slot_of(py_intern_key(name));
+    cache.shape = shape->id;
+    cache.slot = slot < 0 ? AttrCache::NO_SLOT : static_cast<uint32_t>(slot);
+    return slot < 0 ? nullptr : &values[slot];
+}
+
+inline ObjectPtr PyInstance::__getattr__(const Ref<PyString> &name) {
+    int slot = shape->slot_of(py_intern_key(*name));
+    if (slot >= 0 && values[slot]) {
+        return values[slot];
     }
     return classPtr->__getattr__(name);
 }
 
-inline void PyInstance::__setattr__(const std::string &name, ObjectPtr value) {
-    auto key = std::make_shared<PyString>(name);
-    instanceDict->__setitem__(key, value);
+inline void PyInstance::__setattr__(const Ref<PyString> &name, ObjectPtr value) {
+    const PyString *key = py_intern_key(*name);
+    int slot = shape->slot_of(key);
+    if (slot >= 0) {
+        values[slot] = std::move(value);
+        return;
+    }
+    if (classPtr->fixed_layout()) {
+        // Класс со __slots__: других атрибутов у экземпляра быть не может
+        throw RuntimeError("object has no attribute '" + name->get() + "'");
+    }
+    // Новый атрибут: значение — в новый слот (массив растёт удвоением),
+    // экземпляр переходит в следующую форму
+    std::size_t count = shape->size();
+    if (count == capacity_for(count)) {
+        auto *grown = static_cast<ObjectPtr*>(Pool::allocate(capacity_for(count + 1) * sizeof(ObjectPtr)));
+        std::uninitialized_move_n(values, count, grown);
+        std::destroy_n(values, count);
+        if (values) {
+            Pool::deallocate(values, capacity_for(count) * sizeof(ObjectPtr));
+        }
+        values = grown;
+    }
+    new (&values[count]) ObjectPtr(std::move(value));
+    shape = shape->with(key);
 }
 
 inline ObjectPtr PyInstance::__call__(const std::vector<ObjectPtr> & /*args*/) {
     throw RuntimeError("object is not callable");
 }
 
+inline std::size_t PyInstance::__hash__() const {
+    return std::hash<const void*>{}(this);
+}
+
+inline bool PyInstance::__eq__(const Object &other) const {
+    return this == &other;
+}
+
 inline std::string PyInstance::repr() const {
     std::ostringstream ss;
     ss << "<Instance of " << classPtr->name << " at " << this << ">";
@@ -911,82 +2824,225 @@ inline std::type_index PyInstance::type() const {
 }
 
 // -------------------- PyClass --------------------
-inline PyClass::PyClass(std::string className, std::shared_ptr<PyClass> baseClass)
-    : name(className),
-      classDict(std::make_shared<PyDict>()),
-      parent(std::move(baseClass))
-{}
+inline PyClass::PyClass(std::string className, std::vector<Ref<PyClass>> baseClasses)
+    : GcObject(KIND),
+      name(std::move(className)),
+      classDict(make_ref<PyDict>()),
+      bases(std::move(baseClasses))
+{
+    mro.push_back(this);
+    for (PyClass *ancestor : linearize(bases)) {
+        mro.push_back(ancestor);
+    }
+    for (auto &base : bases) {
+        base->subclasses.push_back(this);
+    }
+}
+
+inline PyClass::~PyClass() {
+    for (auto &base : bases) {
+        auto &siblings = base->subclasses;
+        siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+    }
+}
+
+inline void PyClass::gc_traverse(Visit visit, void *ctx) const {
+    gc_visit(classDict, visit, ctx);
+    for (const auto &base : bases) {
+        gc_visit(base, visit, ctx);
+    }
+    for (const auto &entry : attrCache) {
+        gc_visit(entry.second, visit, ctx);
+    }
+}
+
+// Базы не трогаем: по ним деструктор вычёркивает класс из их subclasses.
+// Цикл через словарь класса рвёт gc_clear самого словаря.
+inline void PyClass::gc_clear() {
+    attrCache.clear();
+}
+
+// C3: слияние MRO баз и самого списка баз. На каждом шаге берётся первая
+// голова списка, не встречающаяся в хвосте ни одного списка; если такой
+// нет — порядок противоречив (class C(A, B) при B наследнике A).
+inline std::vector<PyClass*> PyClass::linearize(const std::vector<Ref<PyClass>> &bases) {
+    std::vector<std::vector<PyClass*>> seqs;
+    for (auto &base : bases) {
+        seqs.push_back(base->mro);
+    }
+    std::vector<PyClass*> direct;
+    for (auto &base : bases) {
+        direct.push_back(base.get());
+    }
+    seqs.push_back(std::move(direct));
+
+    // Вместо удаления голов храним, сколько элементов каждого списка уже взято
+    std::vector<std::size_t> taken(seqs.size(), 0);
+    std::vector<PyClass*> result;
+    for (;;) {
+        PyClass *next = nullptr;
+        bool remaining = false;
+        for (std::size_t i = 0; i < seqs.size() && !next; ++i) {
+            if (taken[i] == seqs[i].size()) {
+                continue;
+            }
+            remaining = true;
+            PyClass *head = seqs[i][taken[i]];
+            bool inTail = false;
+            for (std::size_t j = 0; j < seqs.size() && !inTail; ++j) {
+                inTail = std::find(seqs[j].begin() + taken[j] + (taken[j] < seqs[j].size()),
+                                   seqs[j].end(), head) != seqs[j].end();
+            }
+            if (!inTail) {
+                next = head;
+            }
+        }
+        if (!remaining) {
+            return result;
+        }
+        if (!next) {
+            throw RuntimeError("TypeError: Cannot create a consistent method resolution order (MRO)");
+        }
+        result.push_back(next);
+        for (std::size_t i = 0; i < seqs.size(); ++i) {
+            if (taken[i] < seqs[i].size() && seqs[i][taken[i]] == next) {
+                ++taken[i];
+            }
+        }
+    }
+}
+
+inline void PyClass::seal_layout() {
+    // Раскладка баз: непустая (со слотами) может быть только у одной
+    Ref<Shape> layout = Shape::root();
+    bool basesFixed = true;
+    for (auto &base : bases) {
+        basesFixed = basesFixed && base->fixedLayout;
+        if (base->instanceShape->size() == 0 || base->instanceShape == layout) {
+            continue;
+        }
+        if (layout->size() > 0) {
+            throw RuntimeError("TypeError: multiple bases have instance lay-out conflict");
+        }
+        layout = base->instanceShape;
+    }
+
+    // Собственные __slots__: список строк или одна строка
+    static const Ref<PyString> slotsName = py_intern("__slots__");
+    ObjectPtr declared = classDict->get(*slotsName);
+    if (declared) {
+        std::vector<ObjectPtr> names;
+        if (declared->kind() == Kind::String) {
+            names.push_back(declared);
+        } else if (declared->kind() == Kind::List) {
+            names = static_cast<PyList&>(*declared).elements();
+        } else {
+            throw RuntimeError("TypeError: __slots__ must be a list of strings");
+        }
+        for (auto &nameObj : names) {
+            auto *slotName = kind_cast<PyString>(nameObj);
+            if (!slotName) {
+                throw RuntimeError("TypeError: __slots__ items must be strings");
+            }
+            const PyString *key = py_intern_key(*slotName);
+            if (classDict->get(*key)) {
+                throw RuntimeError("ValueError: '" + key->get()
+                    + "' in __slots__ conflicts with class variable");
+            }
+            if (layout->slot_of(key) < 0) {
+                layout = layout->with(key);
+            }
+        }
+    }
 
-// Поиск атрибута у класса: 
-//   1) Сначала проверяем текущее classDict
-//   2) Если не нашли и parent != nullptr, рекурсивно пытаемся найти у parent
-inline ObjectPtr PyClass::__getattr__(const std::string &attrName) {
-    auto key = std::make_shared<PyString>(attrName);
-    if (classDict->__contains__(key)) {
-        return classDict->__getitem__(key);
+    instanceShape = std::move(layout);
+    fixedLayout = declared && basesFixed;
+}
+
+inline ObjectPtr PyClass::lookup(const PyString &attrName) {
+    const PyString *key = py_intern_key(attrName);
+    auto cached = attrCache.find(key);
+    if (cached != attrCache.end()) {
+        return cached->second;
+    }
+    ObjectPtr found;
+    for (PyClass *cls : mro) {
+        if ((found = cls->classDict->get(*key))) {
+            break;
+        }
     }
-    if (parent) {
-        // Если у родителя есть такой атрибут — возвращаем его
-        return parent->__getattr__(attrName);
+    attrCache.emplace(key, found);
+    return found;
+}
+
+inline ObjectPtr PyClass::__getattr__(const Ref<PyString> &attrName) {
+    if (ObjectPtr value = lookup(*attrName)) {
+        return value;
     }
-    throw RuntimeError("object has no attribute '" + attrName + "'");
+    throw RuntimeError("object has no attribute '" + attrName->get() + "'");
 }
 
-inline void PyClass::__setattr__(const std::string &attrName, ObjectPtr value) {
-    auto key = std::make_shared<PyString>(attrName);
-    classDict->__setitem__(key, value);
+inline void PyClass::__setattr__(const Ref<PyString> &attrName, ObjectPtr value) {
+    classDict->__setitem__(attrName, std::move(value));
+    invalidate_cache();
+}
+
+inline void PyClass::invalidate_cache() {
+    attrCache.clear();
+    for (PyClass *sub : subclasses) {
+        sub->invalidate_cache();
+    }
 }
 
 // Вызов «конструктора» класса:
 //   1) Создаём новый PyInstance(this), 
-//   2) Вычисляем, есть ли __init__ в classDict или унаследован из parent,
-//   3) Если есть, вызываем его (первым аргументом self), ловим ReturnException, если он есть,
-//      но не возвращаем его, потому что __init__ в Python практически всегда возвращает None.
+//   2) Вычисляем, есть ли __init__ в classDict или унаследован от предка,
+//   3) Если есть, вызываем его (первым аргументом self); результат return
+//      не используем, потому что __init__ в Python практически всегда возвращает None.
 //   4) Возвращаем созданный экземпляр.
 inline ObjectPtr PyClass::__call__(const std::vector<ObjectPtr> &args) {
     // 1) Новый экземпляр
-    auto instance = std::make_shared<PyInstance>(shared_from_this());
-
-        // 2) Готовим искать метод "__init__" в цепочке классов
-    auto initKey = std::make_shared<PyString>("__init__");
-    try {
-            // Пытаемся найти "__init__" через __getattr__ (поднимется по родителям, если нужно)
-        std::shared_ptr<void> initObjRaw = __getattr__("__init__");
-            // Приводим к PyFunction
-        auto initFn = std::dynamic_pointer_cast<PyFunction>(
-            std::static_pointer_cast<Object>(initObjRaw)
-        );
-        if (!initFn) {
-            // Если нашли что-то, но это не PyFunction → TypeError
-            throw RuntimeError("__init__ is not callable");
-        }
-
-        // 2.1) Собираем аргументы: первым аргументом передаём self, а затем — остальные
-        std::vector<std::shared_ptr<Object>> initArgs;
-        initArgs.reserve(1 + args.size());
-        initArgs.push_back(instance);
-        for (auto &a : args) {
-            initArgs.push_back(a);
-        }
-
-        // 2.2) Вызываем __init__. Если внутри упадёт ReturnException — это просто вернёт управление сюда
-        try {
-            initFn->__call__(initArgs);
-        }
-        catch (const ReturnException &) {
-            // «return» из __init__ игнорируем — в Python __init__ не должен
-            // ничего возвращать, просто инициализировать
-        }
+    auto instance = PyInstance::create(Ref<PyClass>(this));
+
+    // 2) Ищем "__init__" по MRO (может быть унаследован от предка).
+    //    Если его нет нигде — возвращаем «пустой» экземпляр без инициализации.
+    static const Ref<PyString> initName = py_intern("__init__");
+    ObjectPtr initObj = lookup(*initName);
+    if (!initObj) {
+        return instance;
+    }
+
+    // 2.1) Приводим к PyFunction
+    auto initFn = kind_cast<PyFunction>(initObj);
+    if (!initFn) {
+        // Если нашли что-то, но это не PyFunction → TypeError
+        throw RuntimeError("__init__ is not callable");
     }
-        catch (const RuntimeError &err) {
-            // Если __getattr__("__init__") выкинул RuntimeError с сообщением
-            // "object has no attribute '__init__'" или другим, значит __init__ не найден —
-            // просто пропускаем и возвращаем «пустой» экземпляр без инициализации.
-        }
+
+    // 2.2) Собираем аргументы: первым аргументом передаём self, а затем — остальные
+    std::vector<ObjectPtr> initArgs;
+    initArgs.reserve(1 + args.size());
+    initArgs.push_back(instance);
+    for (auto &a : args) {
+        initArgs.push_back(a);
+    }
+
+    // 2.3) Вызываем __init__. «return» из __init__ игнорируем — в Python
+    //      __init__ не должен ничего возвращать, просто инициализировать
+    //      Ошибки внутри тела __init__ не глотаем — они уходят вызывающему.
+    initFn->__call__(initArgs);
 
     return instance;
 }
 
+inline std::size_t PyClass::__hash__() const {
+    return std::hash<const void*>{}(this);
+}
+
+inline bool PyClass::__eq__(const Object &other) const {
+    return this == &other;
+}
+
 inline std::string PyClass::repr() const {
     std::ostringstream ss;
     ss << "<class " << name << " at " << this << ">";
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "object.hpp"
+#include "ast.hpp"
+#include "value.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Семантика операций языка, общая для обоих движков исполнения:
+// обходчика AST (Executor::visit) и стековой машины (Executor::run_code).
+// Сообщения об ошибках формируются здесь один раз, поэтому оба режима
+// печатают одно и то же.
+
+// Истинность значения по правилам Python
+bool is_truthy(const ObjectPtr &obj);
+
+// Имя типа для сообщений об ошибках: "int", "list", "NoneType", ...
+std::string deduceTypeName(const ObjectPtr &obj);
+
+// Объект для литерала (None, int, float, bool, str)
+ObjectPtr literal_value(const LiteralExpr &node);
+
+// Операторы выражений. Текст оператора разбирается один раз: компилятор
+// байткода кладёт код в Instr::arg, и стековая машина не сравнивает строки.
+// Порядок важен: сравнения идут подряд от Eq до Ge.
+enum class BinOp : uint8_t {
+    Add, Sub, Mul, Div, BitOr, BitAnd, BitXor,
+    Eq, Ne, Lt, Gt, Le, Ge,
+    And, Or, In, NotIn,
+    Unsupported         // разобран парсером, но не поддерживается ('//', '%', '**', ...)
+};
+
+enum class UnOp : uint8_t { Plus, Minus, Not };
+
+// Код оператора по тексту; Unsupported — если такого оператора нет
+BinOp binary_op_code(const std::string &op);
+
+// Код унарного оператора по тексту; false — если такого оператора нет
+bool unary_op_code(const std::string &op, UnOp &code);
+
+// Текст оператора для сообщений об ошибках
+const char *op_text(BinOp op);
+const char *op_text(UnOp op);
+
+// left <op> right для арифметики, сравнений, and/or и in/not in
+// (op != Unsupported: ошибку с текстом оператора бросает версия со строкой)
+ObjectPtr binary_op(BinOp op, const ObjectPtr &left, const ObjectPtr &right, int line);
+
+// <op> operand для +, -, not
+ObjectPtr unary_op(UnOp op, const ObjectPtr &operand, int line);
+
+// base[index]
+ObjectPtr get_index(const ObjectPtr &base, const ObjectPtr &index, int line);
+
+// base.name
+ObjectPtr get_attribute(const ObjectPtr &base, const Ref<PyString> &name, int line);
+
+// То же с инлайн-кэшем места обращения: у экземпляра той же формы, что и
+// в прошлый раз, атрибут читается из слота без поиска
+ObjectPtr get_attribute(const ObjectPtr &base, const Ref<PyString> &name, AttrCache &cache, int line);
+
+// base.name = value (с инлайн-кэшем, как get_attribute); атрибут, которого
+// не может быть (не из __slots__), — ошибка как у get_attribute
+void set_attribute(const ObjectPtr &base, const Ref<PyString> &name, ObjectPtr value, AttrCache &cache, int line);
+
+// {k1: v1, k2: v2, ...} — keysAndValues идут парами: ключ, значение
+ObjectPtr build_dict(const std::vector<ObjectPtr> &keysAndValues, int line);
+
+// {e1, e2, ...}
+ObjectPtr build_set(std::vector<ObjectPtr> elems, int line);
+
+// Исключение AssertionError (message может быть nullptr)
+[[noreturn]] void raise_assertion(const ObjectPtr &message, int line);
+
+// exit(value): value == nullptr — exit() без аргумента
+[[noreturn]] void exit_program(const ObjectPtr &value);
+
+// --- Те же операции над Value (стек вычислений и локальные слоты) ---
+// Для int/float/bool/None результат считается без выделения памяти;
+// остальные случаи упаковываются в объекты и идут через версии выше,
+// так что результаты и сообщения об ошибках совпадают.
+
+bool is_truthy(const Value &value);
+
+// Литерал как Value: числа, bool и None — без выделения объекта
+Value literal_as_value(const LiteralExpr &node);
+
+Value binary_op(BinOp op, const Value &left, const Value &right, int line);
+
+Value unary_op(UnOp op, const Value &operand, int line);
+
+// По тексту оператора — для обходчика AST (и для операторов, которых нет
+// в языке: ошибка «unsupported binary operator» с их текстом)
+Value binary_op(const std::string &op, const Value &left, const Value &right, int line);
+
+Value unary_op(const std::string &op, const Value &operand, int line);
+
+// Элемент списка по целому индексу читается из буфера без упаковки
+Value get_index(const Value &base, const Value &index, int line);
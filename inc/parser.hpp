@@ -78,6 +78,10 @@ private:
 
     expression parse_comparison();
 
+    expression parse_bitor();
+    expression parse_bitxor();
+    expression parse_bitand();
+
     expression parse_arith();
     expression parse_term();
     expression parse_factor();
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Пул памяти для объектов интерпретатора (как pymalloc в CPython).
+//
+// Объекты рождаются и умирают миллионами, а размеров у них немного:
+// PyInt, PyFloat, PyString, пара кортежа, экземпляр... Поэтому блоки до
+// MAX_SIZE байт раздаются из классов размеров с шагом GRAIN: у каждого класса
+// свой список свободных блоков, а новые блоки нарезаются подряд из больших
+// страниц (SLAB_SIZE). Освобождённый блок просто кладётся в начало списка
+// своего класса — ни поиска, ни слияния соседей, как в malloc. Страницы
+// системе не возвращаются: освободившееся место ждёт объектов того же размера.
+//
+// Освобождать блок надо с тем же размером, с каким он выделялся (sized delete:
+// RefCounted::operator delete получает размер динамического типа).
+// Блоки больше MAX_SIZE идут в обычный ::operator new.
+//
+// Сборка с -DPY_POOL_DISABLE отключает пул (удобно для ASan: в пуле он не
+// видит обращений к освобождённым объектам). С -DPY_ATOMIC_REFCOUNT у каждого
+// потока свои списки и страницы: блок, освобождённый в чужом потоке,
+// достаётся этому потоку.
+// -----------------------------------------------------------------------------
+
+#ifdef PY_ATOMIC_REFCOUNT
+#define PY_POOL_LOCAL thread_local
+#else
+#define PY_POOL_LOCAL
+#endif
+
+// Счётчики пула (печатаются по --stats)
+struct PoolStats {
+    std::size_t allocations = 0;    // выделений через пул (включая крупные)
+    std::size_t reused = 0;         // из них — из списка свободных блоков
+    std::size_t large = 0;          // крупнее MAX_SIZE — мимо пула
+    std::size_t slabBytes = 0;      // взято у системы страницами
+    std::size_t liveBytes = 0;      // занято живыми блоками (без крупных)
+};
+
+class Pool {
+public:
+    static constexpr std::size_t GRAIN = 8;             // шаг размеров и выравнивание блоков
+    static constexpr std::size_t MAX_SIZE = 512;
+    static constexpr std::size_t SLAB_SIZE = 64 * 1024;
+
+    static void *allocate(std::size_t size) {
+#ifdef PY_POOL_DISABLE
+        return ::operator new(size);
+#else
+        ++totals.allocations;
+        if (size > MAX_SIZE) {
+            ++totals.large;
+            return ::operator new(size);
+        }
+        std::size_t ix = class_of(size);
+        SizeClass &cls = classes[ix];
+        totals.liveBytes += block_size(ix);
+        if (FreeBlock *block = cls.free) {
+            cls.free = block->next;
+            ++totals.reused;
+            return block;
+        }
+        if (cls.cursor == cls.end) {
+            refill(ix);
+        }
+        void *block = cls.cursor;
+        cls.cursor += block_size(ix);
+        return block;
+#endif
+    }
+
+    static void deallocate(void *p, std::size_t size) noexcept {
+#ifdef PY_POOL_DISABLE
+        ::operator delete(p);
+#else
+        if (size > MAX_SIZE) {
+            ::operator delete(p);
+            return;
+        }
+        std::size_t ix = class_of(size);
+        SizeClass &cls = classes[ix];
+        totals.liveBytes -= block_size(ix);
+        auto *block = static_cast<FreeBlock*>(p);
+        block->next = cls.free;
+        cls.free = block;
+#endif
+    }
+
+    static const PoolStats &stats() { return totals; }
+
+private:
+    struct FreeBlock { FreeBlock *next; };
+
+    // Лежит только в статической памяти, а она обнуляется до любого выделения
+    struct SizeClass {
+        FreeBlock *free;
+        char *cursor;               // нарезка текущей страницы: [cursor, end)
+        char *end;
+    };
+
+    static constexpr std::size_t CLASSES = MAX_SIZE / GRAIN;
+
+    // Размеры 1..8 → класс 0, 9..16 → 1, ...
+    static std::size_t class_of(std::size_t size) {
+        return size == 0 ? 0 : (size - 1) / GRAIN;
+    }
+    static std::size_t block_size(std::size_t ix) { return (ix + 1) * GRAIN; }
+
+    // Новая страница для класса ix (src/pool.cpp)
+    static void refill(std::size_t ix);
+
+    static inline PY_POOL_LOCAL SizeClass classes[CLASSES];
+    static inline PY_POOL_LOCAL std::vector<void*> slabs;
+    static inline PY_POOL_LOCAL PoolStats totals;
+};
+
+// Аллокатор для стандартных контейнеров и std::allocate_shared поверх Pool
+// (управляющий блок shared_ptr и объект — одним блоком из пула)
+template <class T>
+struct PoolAllocator {
+    using value_type = T;
+    static_assert(alignof(T) <= Pool::GRAIN, "Pool aligns blocks to Pool::GRAIN bytes");
+
+    PoolAllocator() = default;
+    template <class U>
+    PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+    T *allocate(std::size_t n) { return static_cast<T*>(Pool::allocate(n * sizeof(T))); }
+    void deallocate(T *p, std::size_t n) noexcept { Pool::deallocate(p, n * sizeof(T)); }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U> &) const noexcept { return true; }
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "pool.hpp"
+#ifdef PY_ATOMIC_REFCOUNT
+#include <atomic>
+#endif
+
+// -----------------------------------------------------------------------------
+// Интрузивный подсчёт ссылок для объектов интерпретатора.
+//
+// Счётчик живёт прямо в объекте (RefCounted), а Ref<T> — это просто указатель,
+// который при копировании увеличивает счётчик, а при разрушении уменьшает.
+// В отличие от std::shared_ptr нет отдельного управляющего блока, а
+// инкремент/декремент — обычные (не атомарные) операции: интерпретатор
+// однопоточный.
+//
+// Если объекты всё-таки нужно делить между потоками, сборка с
+// -DPY_ATOMIC_REFCOUNT делает счётчик атомарным.
+//
+// Память под объекты выделяется из пула по классам размеров (см. pool.hpp).
+// -----------------------------------------------------------------------------
+class RefCounted {
+public:
+    RefCounted() = default;
+    RefCounted(const RefCounted &) = delete;
+    RefCounted &operator=(const RefCounted &) = delete;
+    virtual ~RefCounted() = default;
+
+    // Деструктор виртуальный, поэтому size — размер настоящего типа объекта
+    static void *operator new(std::size_t size) { return Pool::allocate(size); }
+    static void operator delete(void *p, std::size_t size) noexcept { Pool::deallocate(p, size); }
+
+    void incref() const noexcept {
+#ifdef PY_ATOMIC_REFCOUNT
+        refs.fetch_add(1, std::memory_order_relaxed);
+#else
+        ++refs;
+#endif
+    }
+
+    void decref() const noexcept {
+#ifdef PY_ATOMIC_REFCOUNT
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+#else
+        if (--refs == 0) {
+            delete this;
+        }
+#endif
+    }
+
+    uint32_t refcount() const noexcept { return refs; }
+
+private:
+#ifdef PY_ATOMIC_REFCOUNT
+    mutable std::atomic<uint32_t> refs{0};
+#else
+    mutable uint32_t refs = 0;
+#endif
+};
+
+// Умный указатель на RefCounted. Объект должен быть создан через new
+// (обычно через make_ref); Ref от this внутри метода тоже допустим —
+// счётчик общий, поэтому аналог shared_from_this не нужен.
+template <class T>
+class Ref {
+public:
+    Ref() noexcept = default;
+    Ref(std::nullptr_t) noexcept {}
+
+    explicit Ref(T *p) noexcept : ptr(p) {
+        if (ptr) ptr->incref();
+    }
+
+    Ref(const Ref &other) noexcept : ptr(other.ptr) {
+        if (ptr) ptr->incref();
+    }
+    Ref(Ref &&other) noexcept : ptr(other.ptr) {
+        other.ptr = nullptr;
+    }
+
+    // Ref<Derived> → Ref<Base>
+    template <class U, class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    Ref(const Ref<U> &other) noexcept : ptr(other.ptr) {
+        if (ptr) ptr->incref();
+    }
+    template <class U, class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    Ref(Ref<U> &&other) noexcept : ptr(other.ptr) {
+        other.ptr = nullptr;
+    }
+
+    ~Ref() {
+        if (ptr) ptr->decref();
+    }
+
+    Ref &operator=(Ref other) noexcept {
+        std::swap(ptr, other.ptr);
+        return *this;
+    }
+
+    T *get() const noexcept { return ptr; }
+    T *operator->() const noexcept { return ptr; }
+    T &operator*() const noexcept { return *ptr; }
+    explicit operator bool() const noexcept { return ptr != nullptr; }
+
+    void reset() noexcept { Ref().swap(*this); }
+    void swap(Ref &other) noexcept { std::swap(ptr, other.ptr); }
+
+    template <class U>
+    bool operator==(const Ref<U> &other) const noexcept { return ptr == other.get(); }
+    bool operator==(std::nullptr_t) const noexcept { return ptr == nullptr; }
+
+private:
+    template <class U> friend class Ref;
+
+    T *ptr = nullptr;
+};
+
+template <class T, class... Args>
+Ref<T> make_ref(Args &&...args) {
+    return Ref<T>(new T(std::forward<Args>(args)...));
+}
+
+template <class T, class U>
+Ref<T> dynamic_ref_cast(const Ref<U> &r) noexcept {
+    return Ref<T>(dynamic_cast<T*>(r.get()));
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ast.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Резолвер имён: проходит AST один раз до исполнения и решает для каждого
+// идентификатора, где будет лежать его значение (см. NameRef в ast.hpp):
+//
+//   - всё, что объявлено на уровне модуля, остаётся Global и ищется
+//     в таблице символов, как и раньше;
+//   - имена, которым внутри функции что-то присваивается (параметры, '=',
+//     переменные for и генераторов, def/class внутри функции), становятся
+//     локальными и получают номер слота в плоском массиве кадра;
+//   - если локальную переменную читает вложенная функция или лямбда,
+//     переменная переезжает в ячейку (cellvar), а вложенная функция получает
+//     её как свободную (freevar) — ячейку захватывают при создании PyFunction.
+//
+// Работает в два прохода: Collect собирает локальные и использованные имена
+// всех функций, затем link_free_variables() раскладывает ячейки,
+// и Annotate записывает результат в узлы AST.
+class Resolver : public ASTVisitor {
+public:
+    void resolve(TransUnit &unit);
+
+    void visit(TransUnit  &node) override;
+    void visit(FuncDecl   &node) override;
+    void visit(ClassDecl  &node) override;
+    void visit(BlockStat  &node) override;
+    void visit(ExprStat   &node) override;
+    void visit(AssignStat &node) override;
+    void visit(IdExpr     &node) override;
+    void visit(LiteralExpr&node) override;
+    void visit(BinaryExpr &node) override;
+    void visit(UnaryExpr  &node) override;
+    void visit(PrimaryExpr  &node) override;
+    void visit(CallExpr   &node) override;
+    void visit(IndexExpr  &node) override;
+    void visit(AttributeExpr &node) override;
+    void visit(ListExpr   &node) override;
+    void visit(DictExpr   &node) override;
+    void visit(SetExpr    &node) override;
+    void visit(TernaryExpr&node) override;
+
+    void visit(CondStat    &node) override;
+    void visit(WhileStat   &node) override;
+    void visit(ForStat     &node) override;
+    void visit(ReturnStat  &node) override;
+    void visit(BreakStat   &node) override;
+    void visit(ContinueStat&node) override;
+    void visit(PassStat    &node) override;
+    void visit(AssertStat  &node) override;
+    void visit(ExitStat    &node) override;
+    void visit(PrintStat   &node) override;
+
+    void visit(ListComp &node) override;
+    void visit(DictComp &node) override;
+    void visit(TupleComp &node) override;
+
+    void visit(LambdaExpr &node) override;
+
+    void visit(class LenStat &node) override;
+    void visit(class DirStat &node) override;
+    void visit(class EnumerateStat &node) override;
+
+private:
+    enum class Pass {
+        Collect, Annotate
+    };
+
+    // Всё, что резолвер знает об одной функции (или лямбде)
+    struct FunctionInfo {
+        FuncDecl *decl = nullptr;
+        FunctionInfo *parent = nullptr;                 // объемлющая функция (nullptr — модуль)
+        std::unordered_map<std::string, int> locals;    // имя → слот
+        std::vector<std::string> localNames;            // слот → имя
+        std::vector<std::string> used;                  // прочитанные имена (в порядке появления)
+        std::unordered_set<std::string> usedSet;
+        std::vector<std::string> cellvars;              // свои локальные, захваченные вложенными
+        std::vector<std::string> freevars;              // захваченные из объемлющих функций
+        std::unordered_map<std::string, int> cells;     // имя → индекс ячейки
+    };
+
+    Pass pass = Pass::Collect;
+    FunctionInfo *current = nullptr;
+    std::vector<std::unique_ptr<FunctionInfo>> functions;   // в порядке обхода (родитель раньше детей)
+    std::unordered_map<FuncDecl*, FunctionInfo*> infoByDecl;
+
+    void bind(const std::string &name, NameRef &ref);   // имя, которому присваивают
+    void use(const std::string &name, NameRef &ref);    // имя, которое читают
+    NameRef ref_for(const std::string &name) const;
+
+    void function(FuncDecl &node, bool bindName);
+    void link_free_variables();
+
+    void accept(ASTNode *node) {
+        if (node) node->accept(*this);
+    }
+};
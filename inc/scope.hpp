@@ -6,11 +6,11 @@
 class Scope {
 public:
     Scope() {
-        current = std::make_shared<SymbolTable>(nullptr);
+        current = std::allocate_shared<SymbolTable>(PoolAllocator<SymbolTable>{}, nullptr);
     }
 
     void enter_scope() {
-        current = std::make_shared<SymbolTable>(current);
+        current = std::allocate_shared<SymbolTable>(PoolAllocator<SymbolTable>{}, current);
     }
 
     void leave_scope() {
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <memory>
 #include <typeindex>
+#include "ref.hpp"
 
 class Object;       
 struct ASTNode;
@@ -15,7 +16,7 @@ enum class SymbolType {
 struct Symbol {
     std::string name;
     SymbolType type = SymbolType::Variable;
-    std::shared_ptr<Object> value;
+    Ref<Object> value;
     ASTNode* decl = nullptr;
 };
 
@@ -6,6 +6,7 @@ enum class TokenType {
     LAMBDA,
     ID, INTNUM, FLOATNUM, STRING, BOOL, NONE,// floatnum(literal) intnum(literal), bool, none
     PLUS, MINUS, STAR, SLASH, DOUBLESLASH, MOD, POW,
+    VBAR, AMPER, CIRCUMFLEX, // | & ^
     EQUAL, NOTEQUAL, LESS, GREATER, LESSEQUAL, GREATEREQUAL,
     AND, OR, NOT,
     IF, ELSE, ELIF,
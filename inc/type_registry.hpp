@@ -85,7 +85,7 @@ private:
             { "__getitem__",  [](ObjectPtr self, auto &args){ return self->__getitem__(args[0]); } },
             { "__contains__", [](ObjectPtr self, auto &args){
                   bool ok = self->__contains__(args[0]);
-                  return std::make_shared<PyBool>(ok);
+                  return py_bool(ok);
               }
             },
         }},
@@ -96,7 +96,7 @@ private:
             { "__getitem__",  [](ObjectPtr self, auto &args){ return self->__getitem__(args[0]); } },
             { "__contains__", [](ObjectPtr self, auto &args){
                   bool ok = self->__contains__(args[0]);
-                  return std::make_shared<PyBool>(ok);
+                  return py_bool(ok);
               }
             },
         }},
@@ -106,7 +106,7 @@ private:
             { "__getitem__",  [](ObjectPtr self, auto &args){ return self->__getitem__(args[0]); } },
             { "__contains__", [](ObjectPtr self, auto &args){
                   bool ok = self->__contains__(args[0]);
-                  return std::make_shared<PyBool>(ok);
+                  return py_bool(ok);
               }
             },
         }},
@@ -116,7 +116,7 @@ private:
             { "__add__",      [](ObjectPtr self, auto &args){ return self->__add__(args[0]); } },
             { "__contains__", [](ObjectPtr self, auto &args){
                   bool ok = self->__contains__(args[0]);
-                  return std::make_shared<PyBool>(ok);
+                  return py_bool(ok);
               }
             },
         }},
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "object.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <memory>
+
+// Value — значение на стеке вычислений и в локальных слотах кадра.
+//
+// None, bool, int (в пределах int64_t) и float хранятся прямо внутри Value (тег + число), поэтому
+// арифметика и сравнения над ними (binary_op/unary_op для Value в operations.hpp)
+// ничего не выделяют в куче. Всё остальное — строки, контейнеры, функции,
+// экземпляры — лежит как обычный ObjectPtr.
+//
+// Объект PyInt/PyFloat/... создаётся («упаковка») только когда значение
+// уходит туда, где нужен ObjectPtr: в список, словарь, атрибут, глобальную
+// переменную или аргумент встроенной функции (см. object()). Если Value
+// получено из готового объекта, этот объект запоминается в box и при упаковке
+// возвращается он же — повторного выделения нет.
+class Value {
+public:
+    enum class Tag : uint8_t {
+        Empty,      // пустой слот (локальная переменная ещё не присвоена)
+        None, Bool, Int, Float,
+        Object      // всё остальное — в box
+    };
+
+    Value() = default;
+
+    // Распаковка готового объекта: скаляры получают тег, сам объект остаётся в box
+    Value(ObjectPtr obj) : box(std::move(obj)) {
+        if (!box) {
+            return;
+        }
+        switch (box->kind()) {
+            case Kind::Int:
+                // Длинное целое (BigInt) остаётся объектом
+                if (static_cast<PyInt&>(*box).is_small()) {
+                    tag = Tag::Int;
+                    i = static_cast<PyInt&>(*box).get();
+                } else {
+                    tag = Tag::Object;
+                }
+                break;
+            case Kind::Float:
+                tag = Tag::Float;
+                d = static_cast<PyFloat&>(*box).get();
+                break;
+            case Kind::Bool:
+                tag = Tag::Bool;
+                b = static_cast<PyBool&>(*box).get();
+                break;
+            case Kind::None:
+                tag = Tag::None;
+                break;
+            default:
+                tag = Tag::Object;
+                break;
+        }
+    }
+
+    template <class T>
+    Value(Ref<T> obj) : Value(ObjectPtr(std::move(obj))) {}
+
+    static Value none() {
+        Value v;
+        v.tag = Tag::None;
+        return v;
+    }
+    static Value boolean(bool value) {
+        Value v;
+        v.tag = Tag::Bool;
+        v.b = value;
+        return v;
+    }
+    static Value integer(int64_t value) {
+        Value v;
+        v.tag = Tag::Int;
+        v.i = value;
+        return v;
+    }
+    static Value real(double value) {
+        Value v;
+        v.tag = Tag::Float;
+        v.d = value;
+        return v;
+    }
+
+    Tag kind() const { return tag; }
+    bool empty() const { return tag == Tag::Empty; }
+    bool is_int() const { return tag == Tag::Int; }
+    bool is_float() const { return tag == Tag::Float; }
+    bool is_object() const { return tag == Tag::Object; }
+
+    // Сам объект для Tag::Object (без копирования Ref)
+    const ObjectPtr &ref() const { return box; }
+
+    int64_t as_int() const { return i; }
+    double as_float() const { return d; }
+    bool as_bool() const { return b; }
+
+    // Объект для этого значения (nullptr для пустого слота). Скаляр без box
+    // упаковывается через py_none/py_bool/py_int (общие объекты) или в новый PyFloat.
+    ObjectPtr object() const {
+        if (box || tag == Tag::Empty) {
+            return box;
+        }
+        switch (tag) {
+            case Tag::None:  return py_none();
+            case Tag::Bool:  return py_bool(b);
+            case Tag::Int:   return py_int(i);
+            case Tag::Float: return make_ref<PyFloat>(d);
+            default:         return box;
+        }
+    }
+
+private:
+    Tag tag = Tag::Empty;
+    union {
+        bool b;
+        int64_t i;
+        double d = 0.0;
+    };
+    ObjectPtr box;      // объект (для Tag::Object — всегда; для скаляров — если был)
+};
+
+// Элемент i буфера списка как Value: неупакованный int/float/bool читается
+// без создания объекта
+inline Value list_item(const ListBuffer &buf, std::size_t i) {
+    using Strategy = ListBuffer::Strategy;
+    switch (buf.strategy()) {
+        case Strategy::Int:   return Value::integer(std::bit_cast<int64_t>(buf.word(i)));
+        case Strategy::Float: return Value::real(std::bit_cast<double>(buf.word(i)));
+        case Strategy::Bool:  return Value::boolean(buf.word(i) != 0);
+        default:              return Value(buf.get(i));
+    }
+}
+
+// Дописать значение в конец буфера; скаляр ложится словом, без упаковки
+inline void list_append(ListBuffer &buf, const Value &value) {
+    using Strategy = ListBuffer::Strategy;
+    switch (value.kind()) {
+        case Value::Tag::Int:   buf.push_word(Strategy::Int, std::bit_cast<uint64_t>(value.as_int())); break;
+        case Value::Tag::Float: buf.push_word(Strategy::Float, std::bit_cast<uint64_t>(value.as_float())); break;
+        case Value::Tag::Bool:  buf.push_word(Strategy::Bool, value.as_bool() ? 1 : 0); break;
+        default:                buf.push_back(value.object()); break;
+    }
+}
@@ -0,0 +1,374 @@
+#include "bigint.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+BigInt::BigInt(int64_t v) : neg(v < 0) {
+    // Модуль через беззнаковое вычитание: -INT64_MIN не помещается в int64_t
+    uint64_t u = neg ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+    while (u) {
+        mag.push_back(static_cast<uint32_t>(u));
+        u >>= 32;
+    }
+}
+
+BigInt::BigInt(bool negative, Mag magnitude) : neg(negative), mag(std::move(magnitude)) {
+    trim(mag);
+    if (mag.empty()) {
+        neg = false;
+    }
+}
+
+BigInt BigInt::from_string(std::string_view text) {
+    bool negative = false;
+    if (!text.empty() && (text[0] == '-' || text[0] == '+')) {
+        negative = text[0] == '-';
+        text.remove_prefix(1);
+    }
+    if (text.empty()) {
+        throw std::invalid_argument("invalid literal for int()");
+    }
+
+    // Накапливаем по 9 десятичных цифр: mag = mag * 10^k + chunk
+    Mag mag;
+    std::size_t first = text.size() % 9 ? text.size() % 9 : 9;
+    for (std::size_t pos = 0; pos < text.size(); ) {
+        std::size_t len = pos == 0 ? first : 9;
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for (std::size_t i = pos; i < pos + len; ++i) {
+            char c = text[i];
+            if (c < '0' || c > '9') {
+                throw std::invalid_argument("invalid literal for int()");
+            }
+            chunk = chunk * 10 + static_cast<uint32_t>(c - '0');
+            scale *= 10;
+        }
+        uint64_t carry = chunk;
+        for (auto &limb : mag) {
+            uint64_t cur = static_cast<uint64_t>(limb) * scale + carry;
+            limb = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        if (carry) {
+            mag.push_back(static_cast<uint32_t>(carry));
+        }
+        pos += len;
+    }
+    return BigInt(negative, std::move(mag));
+}
+
+bool BigInt::fits_int64() const {
+    if (mag.size() <= 1) {
+        return true;
+    }
+    if (mag.size() > 2) {
+        return false;
+    }
+    uint64_t u = (static_cast<uint64_t>(mag[1]) << 32) | mag[0];
+    return neg ? u <= (uint64_t(1) << 63) : u < (uint64_t(1) << 63);
+}
+
+int64_t BigInt::to_int64() const {
+    return static_cast<int64_t>(low_bits());
+}
+
+uint64_t BigInt::low_bits() const {
+    uint64_t u = 0;
+    for (std::size_t i = std::min<std::size_t>(mag.size(), 2); i-- > 0; ) {
+        u = (u << 32) | mag[i];
+    }
+    return neg ? 0 - u : u;
+}
+
+BigInt BigInt::from_double(double whole) {
+    // |whole| = m * 2^exp, m — 53-битная мантисса; целое число сдвигается
+    // на exp бит влево (отрицательный exp у целого — это нули в мантиссе)
+    int exp;
+    double frac = std::frexp(std::fabs(whole), &exp);
+    uint64_t m = static_cast<uint64_t>(std::ldexp(frac, 53));
+    exp -= 53;
+    if (exp < 0) {
+        m >>= -exp;
+        exp = 0;
+    }
+    Mag mag(static_cast<std::size_t>(exp / 32), 0);
+    unsigned __int128 shifted = static_cast<unsigned __int128>(m) << (exp % 32);
+    while (shifted) {
+        mag.push_back(static_cast<uint32_t>(shifted));
+        shifted >>= 32;
+    }
+    return BigInt(whole < 0, std::move(mag));
+}
+
+double BigInt::to_double() const {
+    double d = 0.0;
+    for (std::size_t i = mag.size(); i-- > 0; ) {
+        d = d * 4294967296.0 + mag[i];
+    }
+    return neg ? -d : d;
+}
+
+double BigInt::to_frexp(long &exp) const {
+    // Старших трёх цифр (96 бит) хватает на 53 бита мантиссы
+    std::size_t take = std::min<std::size_t>(mag.size(), 3);
+    double d = 0.0;
+    for (std::size_t i = mag.size(); i-- > mag.size() - take; ) {
+        d = d * 4294967296.0 + mag[i];
+    }
+    int e = 0;
+    double m = std::frexp(d, &e);
+    exp = e + 32 * static_cast<long>(mag.size() - take);
+    return neg ? -m : m;
+}
+
+std::string BigInt::to_string() const {
+    if (mag.empty()) {
+        return "0";
+    }
+    // Отщепляем младшие 9 цифр делением всего числа на 10^9, пока не кончится
+    constexpr uint32_t CHUNK = 1000000000;
+    Mag rest = mag;
+    std::vector<uint32_t> chunks;
+    chunks.reserve(rest.size() * 32 / 29 + 1);
+    while (!rest.empty()) {
+        uint64_t rem = 0;
+        for (std::size_t i = rest.size(); i-- > 0; ) {
+            uint64_t cur = (rem << 32) | rest[i];
+            rest[i] = static_cast<uint32_t>(cur / CHUNK);
+            rem = cur % CHUNK;
+        }
+        trim(rest);
+        chunks.push_back(static_cast<uint32_t>(rem));
+    }
+
+    std::string out = neg ? "-" : "";
+    out += std::to_string(chunks.back());
+    for (std::size_t i = chunks.size() - 1; i-- > 0; ) {
+        std::string part = std::to_string(chunks[i]);
+        out.append(9 - part.size(), '0');
+        out += part;
+    }
+    return out;
+}
+
+BigInt BigInt::operator-() const {
+    return BigInt(!neg, mag);
+}
+
+BigInt operator+(const BigInt &a, const BigInt &b) {
+    if (a.neg == b.neg) {
+        return BigInt(a.neg, BigInt::add_mag(a.mag, b.mag));
+    }
+    // Разные знаки: из большего по модулю вычитаем меньший
+    if (BigInt::cmp_mag(a.mag, b.mag) >= 0) {
+        return BigInt(a.neg, BigInt::sub_mag(a.mag, b.mag));
+    }
+    return BigInt(b.neg, BigInt::sub_mag(b.mag, a.mag));
+}
+
+BigInt operator-(const BigInt &a, const BigInt &b) {
+    return a + (-b);
+}
+
+BigInt operator*(const BigInt &a, const BigInt &b) {
+    return BigInt(a.neg != b.neg, BigInt::mul_mag(a.mag, b.mag));
+}
+
+BigInt operator|(const BigInt &a, const BigInt &b) {
+    return BigInt::bitwise(a, b, [](uint32_t x, uint32_t y) { return x | y; });
+}
+
+BigInt operator&(const BigInt &a, const BigInt &b) {
+    return BigInt::bitwise(a, b, [](uint32_t x, uint32_t y) { return x & y; });
+}
+
+BigInt operator^(const BigInt &a, const BigInt &b) {
+    return BigInt::bitwise(a, b, [](uint32_t x, uint32_t y) { return x ^ y; });
+}
+
+int compare(const BigInt &a, const BigInt &b) {
+    if (a.neg != b.neg) {
+        return a.neg ? -1 : 1;
+    }
+    int c = BigInt::cmp_mag(a.mag, b.mag);
+    return a.neg ? -c : c;
+}
+
+// ---------------------------------------------------------------------------
+// Операции над модулями
+// ---------------------------------------------------------------------------
+
+void BigInt::trim(Mag &m) {
+    while (!m.empty() && m.back() == 0) {
+        m.pop_back();
+    }
+}
+
+int BigInt::cmp_mag(const Mag &a, const Mag &b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (std::size_t i = a.size(); i-- > 0; ) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+BigInt::Mag BigInt::add_mag(const Mag &a, const Mag &b) {
+    const Mag &longer = a.size() >= b.size() ? a : b;
+    const Mag &shorter = a.size() >= b.size() ? b : a;
+    Mag out(longer.size() + 1);
+    uint64_t carry = 0;
+    for (std::size_t i = 0; i < longer.size(); ++i) {
+        uint64_t cur = static_cast<uint64_t>(longer[i]) + (i < shorter.size() ? shorter[i] : 0) + carry;
+        out[i] = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+    out[longer.size()] = static_cast<uint32_t>(carry);
+    trim(out);
+    return out;
+}
+
+BigInt::Mag BigInt::sub_mag(const Mag &a, const Mag &b) {
+    Mag out = a;
+    sub_in_place(out, b);
+    return out;
+}
+
+void BigInt::sub_in_place(Mag &acc, const Mag &x) {
+    int64_t borrow = 0;
+    for (std::size_t i = 0; i < acc.size(); ++i) {
+        if (i >= x.size() && borrow == 0) {
+            break;
+        }
+        int64_t cur = static_cast<int64_t>(acc[i]) - (i < x.size() ? x[i] : 0) - borrow;
+        borrow = cur < 0;
+        acc[i] = static_cast<uint32_t>(cur + (borrow << 32));
+    }
+    trim(acc);
+}
+
+// acc += x * 2^(32*shift); acc должен уже вмещать результат или будет расширен
+void BigInt::add_shifted(Mag &acc, const Mag &x, std::size_t shift) {
+    if (acc.size() < x.size() + shift + 1) {
+        acc.resize(x.size() + shift + 1, 0);
+    }
+    uint64_t carry = 0;
+    std::size_t i = 0;
+    for (; i < x.size(); ++i) {
+        uint64_t cur = static_cast<uint64_t>(acc[shift + i]) + x[i] + carry;
+        acc[shift + i] = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+    for (std::size_t j = shift + i; carry; ++j) {
+        if (j == acc.size()) {
+            acc.push_back(0);
+        }
+        uint64_t cur = static_cast<uint64_t>(acc[j]) + carry;
+        acc[j] = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+}
+
+BigInt::Mag BigInt::mul_mag(const Mag &a, const Mag &b) {
+    if (a.empty() || b.empty()) {
+        return {};
+    }
+    if (std::min(a.size(), b.size()) < KARATSUBA_CUTOFF) {
+        return mul_school(a, b);
+    }
+    return mul_karatsuba(a, b);
+}
+
+BigInt::Mag BigInt::mul_school(const Mag &a, const Mag &b) {
+    Mag out(a.size() + b.size(), 0);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        uint64_t carry = 0;
+        uint64_t ai = a[i];
+        for (std::size_t j = 0; j < b.size(); ++j) {
+            uint64_t cur = ai * b[j] + out[i + j] + carry;
+            out[i + j] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        out[i + b.size()] = static_cast<uint32_t>(carry);
+    }
+    trim(out);
+    return out;
+}
+
+BigInt::Mag BigInt::mul_karatsuba(const Mag &x, const Mag &y) {
+    const Mag &a = x.size() >= y.size() ? x : y;
+    const Mag &b = x.size() >= y.size() ? y : x;
+
+    // Сильно разные длины: режем длинное на куски длины короткого
+    if (a.size() >= 2 * b.size()) {
+        Mag out;
+        for (std::size_t off = 0; off < a.size(); off += b.size()) {
+            Mag part(a.begin() + off, a.begin() + std::min(a.size(), off + b.size()));
+            trim(part);
+            add_shifted(out, mul_mag(part, b), off);
+        }
+        trim(out);
+        return out;
+    }
+
+    // a = a1*B^m + a0, b = b1*B^m + b0:
+    // a*b = z2*B^2m + (z1 - z2 - z0)*B^m + z0, где z1 = (a0+a1)(b0+b1)
+    std::size_t m = a.size() / 2;
+    Mag a0(a.begin(), a.begin() + m), a1(a.begin() + m, a.end());
+    Mag b0(b.begin(), b.begin() + m), b1(b.begin() + m, b.end());
+    trim(a0);
+    trim(b0);
+
+    Mag z0 = mul_mag(a0, b0);
+    Mag z2 = mul_mag(a1, b1);
+    Mag z1 = mul_mag(add_mag(a0, a1), add_mag(b0, b1));
+    sub_in_place(z1, z0);
+    sub_in_place(z1, z2);
+
+    Mag out(a.size() + b.size() + 1, 0);
+    add_shifted(out, z0, 0);
+    add_shifted(out, z1, m);
+    add_shifted(out, z2, 2 * m);
+    trim(out);
+    return out;
+}
+
+// Побитовая операция в дополнительном коде: оба числа расширяются на одну
+// цифру больше длинного (знаковые биты), результат переводится обратно.
+template <class Op>
+BigInt BigInt::bitwise(const BigInt &a, const BigInt &b, Op op) {
+    std::size_t n = std::max(a.mag.size(), b.mag.size()) + 1;
+    auto twos = [n](const BigInt &v) {
+        Mag out(n, 0);
+        std::copy(v.mag.begin(), v.mag.end(), out.begin());
+        if (v.neg) {
+            uint64_t carry = 1;
+            for (auto &limb : out) {
+                uint64_t cur = static_cast<uint64_t>(static_cast<uint32_t>(~limb)) + carry;
+                limb = static_cast<uint32_t>(cur);
+                carry = cur >> 32;
+            }
+        }
+        return out;
+    };
+    Mag ta = twos(a), tb = twos(b);
+    Mag r(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = op(ta[i], tb[i]);
+    }
+    bool negative = r[n - 1] >> 31;
+    if (negative) {
+        uint64_t carry = 1;
+        for (auto &limb : r) {
+            uint64_t cur = static_cast<uint64_t>(static_cast<uint32_t>(~limb)) + carry;
+            limb = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+    }
+    return BigInt(negative, std::move(r));
+}
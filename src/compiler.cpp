@@ -0,0 +1,504 @@
+#include "compiler.hpp"
+#include "operations.hpp"
+
+#include <unordered_set>
+
+
+std::shared_ptr<CodeObject> Compiler::compile(TransUnit &unit) {
+    auto module = std::make_shared<CodeObject>();
+    module->name = "<module>";
+    code = module.get();
+    inFunction = false;
+    loops.clear();
+
+    unit.accept(*this);
+    return module;
+}
+
+size_t Compiler::emit(OpCode op, int arg, int arg2, int line) {
+    code->code.push_back(Instr{op, arg, arg2, line});
+    return code->code.size() - 1;
+}
+
+void Compiler::patch(size_t at, size_t target) {
+    code->code[at].arg = static_cast<int>(target);
+}
+
+int Compiler::add_const(Value value) {
+    code->consts.push_back(std::move(value));
+    return static_cast<int>(code->consts.size() - 1);
+}
+
+int Compiler::add_name(const std::string &name) {
+    for (size_t i = 0; i < code->names.size(); ++i) {
+        if (code->names[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    code->names.push_back(name);
+    code->name_objs.push_back(py_intern(name));
+    return static_cast<int>(code->names.size() - 1);
+}
+
+int Compiler::add_attr_cache() {
+    code->attr_caches.emplace_back();
+    return static_cast<int>(code->attr_caches.size() - 1);
+}
+
+void Compiler::load_name(const NameRef &ref, const std::string &name, int line) {
+    switch (ref.scope) {
+        case NameScope::Local:
+            emit(OpCode::LOAD_LOCAL, ref.slot, line);
+            break;
+        case NameScope::Cell:
+            emit(OpCode::LOAD_CELL, ref.slot, line);
+            break;
+        case NameScope::Global:
+        default:
+            emit(OpCode::LOAD_GLOBAL, add_name(name), line);
+            break;
+    }
+}
+
+void Compiler::store_name(const NameRef &ref, const std::string &name, int line, SymbolType type) {
+    switch (ref.scope) {
+        case NameScope::Local:
+            emit(OpCode::STORE_LOCAL, ref.slot, line);
+            break;
+        case NameScope::Cell:
+            emit(OpCode::STORE_CELL, ref.slot, line);
+            break;
+        case NameScope::Global:
+        default:
+            emit(OpCode::STORE_GLOBAL, add_name(name), static_cast<int>(type), line);
+            break;
+    }
+}
+
+void Compiler::function(FuncDecl &node, int line) {
+    // 1) default-значения вычисляются при объявлении, в объемлющем коде
+    for (auto &pr : node.defaultParams) {
+        if (pr.second) {
+            pr.second->accept(*this);
+        } else {
+            emit(OpCode::LOAD_CONST, add_const(Value::none()), line);
+        }
+    }
+
+    // 2) Тело — в собственный CodeObject; циклы объемлющего кода внутри не видны
+    auto body = std::make_shared<CodeObject>();
+    body->name = node.name;
+
+    CodeObject *savedCode = code;
+    bool savedInFunction = inFunction;
+    std::vector<Loop> savedLoops = std::move(loops);
+    code = body.get();
+    inFunction = true;
+    loops.clear();
+
+    accept(node.body.get());
+    // Дошли до конца тела без return — возвращаем None
+    emit(OpCode::LOAD_CONST, add_const(Value::none()), node.line);
+    emit(OpCode::RETURN_VALUE, 0, node.line);
+
+    code = savedCode;
+    inFunction = savedInFunction;
+    loops = std::move(savedLoops);
+    node.code = std::move(body);
+
+    // 3) Создание PyFunction в момент исполнения объявления
+    code->functions.push_back(&node);
+    emit(OpCode::MAKE_FUNCTION, static_cast<int>(code->functions.size() - 1),
+         static_cast<int>(node.defaultParams.size()), line);
+}
+
+template <class Body>
+void Compiler::comprehension(Expression &iterable, const NameRef &ref, const std::string &var,
+                             int line, Body body) {
+    // Контейнер-результат уже на стеке; генератор обходит копию элементов
+    iterable.accept(*this);
+    emit(OpCode::GET_ITER, 1, line);
+    size_t loop = emit(OpCode::FOR_ITER, 0, line);
+    store_name(ref, var, line);
+    body();
+    emit(OpCode::JUMP, static_cast<int>(loop), line);
+    patch(loop, here());
+}
+
+void Compiler::visit(TransUnit &node) {
+    for (auto &unit : node.units) {
+        unit->accept(*this);
+    }
+}
+
+void Compiler::visit(FuncDecl &node) {
+    // Повторяющиеся имена параметров — ошибка объявления (как и у обходчика AST)
+    std::unordered_set<std::string> seen;
+    bool duplicate = false;
+    auto check = [&](const std::string &name) {
+        if (!seen.insert(name).second) {
+            reporter.add_error(
+                "Line " + std::to_string(node.line)
+                + ": duplicate parameter name '" + name
+                + "' in function '" + node.name + "'"
+            );
+            duplicate = true;
+        }
+    };
+    for (const auto &name : node.posParams) {
+        check(name);
+    }
+    for (const auto &pr : node.defaultParams) {
+        check(pr.first);
+    }
+    if (duplicate) {
+        return;
+    }
+
+    function(node, node.line);
+    store_name(node.nameRef, node.name, node.line, SymbolType::Function);
+}
+
+void Compiler::visit(ClassDecl &node) {
+    // MAKE_CLASS создаёт класс и сразу записывает его под именем (см. Executor::make_class);
+    // класс остаётся на стеке, пока заполняем его словарь полями и методами.
+    code->classes.push_back(&node);
+    emit(OpCode::MAKE_CLASS, static_cast<int>(code->classes.size() - 1), node.line);
+
+    for (auto &field : node.fields) {
+        if (field->initExpr) {
+            field->initExpr->accept(*this);
+        } else {
+            emit(OpCode::LOAD_CONST, add_const(Value::none()), node.line);
+        }
+        emit(OpCode::SET_CLASS_ATTR, add_name(field->name), node.line);
+    }
+    for (auto &method : node.methods) {
+        function(*method, node.line);
+        emit(OpCode::SET_CLASS_ATTR, add_name(method->name), node.line);
+    }
+
+    emit(OpCode::END_CLASS, 0, node.line);
+}
+
+void Compiler::visit(BlockStat &node) {
+    for (auto &stat : node.statements) {
+        stat->accept(*this);
+    }
+}
+
+void Compiler::visit(ExprStat &node) {
+    if (node.expr) {
+        node.expr->accept(*this);
+        emit(OpCode::POP_TOP, 0, node.line);
+    }
+}
+
+void Compiler::visit(AssignStat &node) {
+    if (node.right) {
+        node.right->accept(*this);
+    } else {
+        emit(OpCode::LOAD_CONST, add_const(Value::none()), node.line);
+    }
+
+    if (auto id = dynamic_cast<IdExpr*>(node.left.get())) {
+        store_name(id->ref, id->name, node.line);
+        return;
+    }
+    if (auto idx = dynamic_cast<IndexExpr*>(node.left.get())) {
+        idx->base->accept(*this);
+        idx->index->accept(*this);
+        emit(OpCode::STORE_INDEX, 0, node.line);
+        return;
+    }
+    if (auto attr = dynamic_cast<AttributeExpr*>(node.left.get())) {
+        attr->obj->accept(*this);
+        emit(OpCode::STORE_ATTR, add_name(attr->name), add_attr_cache(), node.line);
+        return;
+    }
+
+    throw RuntimeError(
+        "Line " + std::to_string(node.line)
+        + ": invalid assignment target"
+    );
+}
+
+void Compiler::visit(IdExpr &node) {
+    load_name(node.ref, node.name, node.line);
+}
+
+void Compiler::visit(LiteralExpr &node) {
+    emit(OpCode::LOAD_CONST, add_const(literal_as_value(node)), node.line);
+}
+
+void Compiler::visit(BinaryExpr &node) {
+    node.left->accept(*this);
+    node.right->accept(*this);
+    // Оператор разбирается здесь, а не на каждом исполнении; неподдерживаемый
+    // оператор — ошибка только при исполнении, как у обходчика AST
+    BinOp op = binary_op_code(node.op);
+    int text = op == BinOp::Unsupported ? add_name(node.op) : 0;
+    emit(OpCode::BINARY, static_cast<int>(op), text, node.line);
+}
+
+void Compiler::visit(UnaryExpr &node) {
+    if (!node.operand) {
+        throw RuntimeError(
+            "Line " + std::to_string(node.line)
+            + ": missing operand for unary operator '" + node.op + "'"
+        );
+    }
+    UnOp op;
+    if (!unary_op_code(node.op, op)) {
+        throw RuntimeError(
+            "Line " + std::to_string(node.line)
+            + " SyntaxError: invalid unary operator '" + node.op + "'"
+        );
+    }
+    node.operand->accept(*this);
+    emit(OpCode::UNARY, static_cast<int>(op), node.line);
+}
+
+void Compiler::visit(PrimaryExpr &node) {
+    // Ровно одно из подвыражений непустое — компилируем его
+    accept(node.literalExpr.get());
+    accept(node.idExpr.get());
+    accept(node.callExpr.get());
+    accept(node.indexExpr.get());
+    accept(node.parenExpr.get());
+    accept(node.ternaryExpr.get());
+}
+
+void Compiler::visit(CallExpr &node) {
+    node.caller->accept(*this);
+    for (auto &arg : node.arguments) {
+        arg->accept(*this);
+    }
+    emit(OpCode::CALL, static_cast<int>(node.arguments.size()), node.line);
+}
+
+void Compiler::visit(IndexExpr &node) {
+    node.base->accept(*this);
+    node.index->accept(*this);
+    emit(OpCode::LOAD_INDEX, 0, node.line);
+}
+
+void Compiler::visit(AttributeExpr &node) {
+    node.obj->accept(*this);
+    emit(OpCode::LOAD_ATTR, add_name(node.name), add_attr_cache(), node.line);
+}
+
+void Compiler::visit(ListExpr &node) {
+    for (auto &elem : node.elems) {
+        if (elem) {
+            elem->accept(*this);
+        } else {
+            emit(OpCode::LOAD_CONST, add_const(Value::none()), node.line);
+        }
+    }
+    emit(OpCode::BUILD_LIST, static_cast<int>(node.elems.size()), node.line);
+}
+
+void Compiler::visit(DictExpr &node) {
+    for (auto &item : node.items) {
+        item.first->accept(*this);
+        item.second->accept(*this);
+    }
+    emit(OpCode::BUILD_DICT, static_cast<int>(node.items.size()), node.line);
+}
+
+void Compiler::visit(SetExpr &node) {
+    for (auto &elem : node.elems) {
+        elem->accept(*this);
+    }
+    emit(OpCode::BUILD_SET, static_cast<int>(node.elems.size()), node.line);
+}
+
+void Compiler::visit(TernaryExpr &node) {
+    node.condition->accept(*this);
+    size_t toElse = emit(OpCode::POP_JUMP_IF_FALSE, 0, node.line);
+    node.trueExpr->accept(*this);
+    size_t toEnd = emit(OpCode::JUMP, 0, node.line);
+    patch(toElse, here());
+    node.falseExpr->accept(*this);
+    patch(toEnd, here());
+}
+
+void Compiler::visit(CondStat &node) {
+    std::vector<size_t> toEnd;
+
+    node.condition->accept(*this);
+    size_t toNext = emit(OpCode::POP_JUMP_IF_FALSE, 0, node.line);
+    accept(node.ifblock.get());
+    toEnd.push_back(emit(OpCode::JUMP, 0, node.line));
+
+    for (auto &elif : node.elifblocks) {
+        patch(toNext, here());
+        elif.first->accept(*this);
+        toNext = emit(OpCode::POP_JUMP_IF_FALSE, 0, node.line);
+        accept(elif.second.get());
+        toEnd.push_back(emit(OpCode::JUMP, 0, node.line));
+    }
+
+    patch(toNext, here());
+    accept(node.elseblock.get());
+    for (size_t at : toEnd) {
+        patch(at, here());
+    }
+}
+
+void Compiler::visit(WhileStat &node) {
+    size_t start = here();
+    node.condition->accept(*this);
+    size_t toExit = emit(OpCode::POP_JUMP_IF_FALSE, 0, node.line);
+
+    loops.push_back(Loop{false, start, {}});
+    accept(node.body.get());
+    emit(OpCode::JUMP, static_cast<int>(start), node.line);
+
+    patch(toExit, here());
+    for (size_t at : loops.back().breakJumps) {
+        patch(at, here());
+    }
+    loops.pop_back();
+}
+
+void Compiler::visit(ForStat &node) {
+    node.iterable->accept(*this);
+    emit(OpCode::GET_ITER, 0, node.line);
+    size_t start = emit(OpCode::FOR_ITER, 0, node.line);
+
+    if (node.iterators.size() == 1) {
+        store_name(node.iteratorRefs[0], node.iterators[0], node.line);
+    } else {
+        emit(OpCode::UNPACK, static_cast<int>(node.iterators.size()), node.line);
+        for (size_t k = 0; k < node.iterators.size(); ++k) {
+            store_name(node.iteratorRefs[k], node.iterators[k], node.line);
+        }
+    }
+
+    loops.push_back(Loop{true, start, {}});
+    accept(node.body.get());
+    emit(OpCode::JUMP, static_cast<int>(start), node.line);
+
+    // FOR_ITER снимает итератор сам, break — перед переходом (см. visit(BreakStat))
+    patch(start, here());
+    for (size_t at : loops.back().breakJumps) {
+        patch(at, here());
+    }
+    loops.pop_back();
+}
+
+void Compiler::visit(ReturnStat &node) {
+    if (!inFunction) {
+        throw RuntimeError(
+            "Line " + std::to_string(node.line)
+            + " SyntaxError: 'return' outside function"
+        );
+    }
+    if (tailCalls && node.tailCall) {
+        // TAIL_CALL переиспользует кадр, если вызывают пользовательскую функцию;
+        // иначе он работает как CALL, и результат возвращает RETURN_VALUE.
+        CallExpr &call = *node.tailCall;
+        call.caller->accept(*this);
+        for (auto &arg : call.arguments) {
+            arg->accept(*this);
+        }
+        emit(OpCode::TAIL_CALL, static_cast<int>(call.arguments.size()), call.line);
+    } else if (node.expr) {
+        node.expr->accept(*this);
+    } else {
+        emit(OpCode::LOAD_CONST, add_const(Value::none()), node.line);
+    }
+    emit(OpCode::RETURN_VALUE, 0, node.line);
+}
+
+void Compiler::visit(BreakStat &node) {
+    if (loops.empty()) {
+        throw RuntimeError(
+            "Line " + std::to_string(node.line)
+            + " SyntaxError: 'break' outside loop"
+        );
+    }
+    if (loops.back().isFor) {
+        emit(OpCode::POP_TOP, 0, node.line);
+    }
+    loops.back().breakJumps.push_back(emit(OpCode::JUMP, 0, node.line));
+}
+
+void Compiler::visit(ContinueStat &node) {
+    if (loops.empty()) {
+        throw RuntimeError(
+            "Line " + std::to_string(node.line)
+            + " SyntaxError: 'continue' not properly in loop"
+        );
+    }
+    emit(OpCode::JUMP, static_cast<int>(loops.back().continueTarget), node.line);
+}
+
+void Compiler::visit(PassStat &node) {}
+
+void Compiler::visit(AssertStat &node) {
+    node.condition->accept(*this);
+    size_t toEnd = emit(OpCode::POP_JUMP_IF_TRUE, 0, node.line);
+    if (node.message) {
+        node.message->accept(*this);
+    }
+    emit(OpCode::ASSERT_FAIL, node.message ? 1 : 0, node.line);
+    patch(toEnd, here());
+}
+
+void Compiler::visit(ExitStat &node) {
+    if (node.expr) {
+        node.expr->accept(*this);
+    }
+    emit(OpCode::EXIT, node.expr ? 1 : 0, node.line);
+}
+
+void Compiler::visit(PrintStat &node) {
+    if (node.expr) {
+        node.expr->accept(*this);
+    }
+    emit(OpCode::PRINT, node.expr ? 1 : 0, node.line);
+}
+
+void Compiler::visit(ListComp &node) {
+    emit(OpCode::BUILD_LIST, 0, node.line);
+    comprehension(*node.iterableExpr, node.iterRef, node.iterVar, node.line, [&] {
+        node.valueExpr->accept(*this);
+        emit(OpCode::LIST_APPEND, 0, node.line);
+    });
+}
+
+void Compiler::visit(DictComp &node) {
+    emit(OpCode::BUILD_DICT, 0, node.line);
+    comprehension(*node.iterableExpr, node.iterRef, node.iterVar, node.line, [&] {
+        node.keyExpr->accept(*this);
+        node.valueExpr->accept(*this);
+        emit(OpCode::DICT_SET, 0, node.line);
+    });
+}
+
+void Compiler::visit(TupleComp &node) {
+    // Элементы собираются в список, готовый список превращается в кортеж
+    emit(OpCode::BUILD_LIST, 0, node.line);
+    comprehension(*node.iterableExpr, node.iterRef, node.iterVar, node.line, [&] {
+        node.valueExpr->accept(*this);
+        emit(OpCode::LIST_APPEND, 0, node.line);
+    });
+    emit(OpCode::LIST_TO_TUPLE, 0, node.line);
+}
+
+void Compiler::visit(LambdaExpr &node) {
+    if (!node.decl) {
+        throw RuntimeError(
+            "Line " + std::to_string(node.line)
+            + ": internal error: lambda was not resolved"
+        );
+    }
+    function(*node.decl, node.line);
+}
+
+void Compiler::visit(LenStat &node) {}
+void Compiler::visit(DirStat &node) {}
+void Compiler::visit(EnumerateStat &node) {}
@@ -1,103 +1,109 @@
 #include "executer.hpp"
 #include "type_registry.hpp"
 #include "object.hpp"
-#include "executer_excepts.hpp"
+#include "completion.hpp"
+#include "resolver.hpp"
+#include "operations.hpp"
+#include "compiler.hpp"
 #include <unordered_set>
 #include <memory>
 #include <iostream>
 
 
 
-auto is_truthy(ObjectPtr &obj) {
-        if (auto b = std::dynamic_pointer_cast<PyBool>(obj)) {
-            return b->get();
-        }
-        if (auto i = std::dynamic_pointer_cast<PyInt>(obj)) {
-            return i->get() != 0;
-        }
-        if (auto f = std::dynamic_pointer_cast<PyFloat>(obj)) {
-            return f->get() != 0.0;
-        }
-        if (auto s = std::dynamic_pointer_cast<PyString>(obj)) {
-            // Строка ложна, если она пустая
-            return !s->get().empty();
-        }
-        if (auto lst = std::dynamic_pointer_cast<PyList>(obj)) {
-            // Список ложен, если в нём нет элементов
-            return !lst->getElements().empty();
-        }
-        if (auto d = std::dynamic_pointer_cast<PyDict>(obj)) {
-            // Словарь ложен, если он пустой
-            // repr() для пустого словаря — "{}", длина 2
-            return d->repr().size() > 2;
-        }
-        if (auto st = std::dynamic_pointer_cast<PySet>(obj)) {
-            // Множество ложено, если оно пустое
-            // repr() для пустого множества — "{}", длина 2
-            return st->repr().size() > 2;
-        }
-        if (std::dynamic_pointer_cast<PyNone>(obj)) {
-            // None всегда ложь
-            return false;
-        }
-        // Любые другие объекты (функции, пользовательские объекты и т.д.) считаются истинными
-        return true;
-};
-
-auto deduceTypeName(ObjectPtr &obj) {
-        if (std::dynamic_pointer_cast<PyInt>(obj))    return std::string("int");
-        if (std::dynamic_pointer_cast<PyFloat>(obj))  return std::string("float");
-        if (std::dynamic_pointer_cast<PyBool>(obj))   return std::string("bool");
-        if (std::dynamic_pointer_cast<PyString>(obj)) return std::string("str");
-        if (std::dynamic_pointer_cast<PyList>(obj))   return std::string("list");
-        if (std::dynamic_pointer_cast<PyDict>(obj))   return std::string("dict");
-        if (std::dynamic_pointer_cast<PySet>(obj))    return std::string("set");
-        if (std::dynamic_pointer_cast<PyNone>(obj))   return std::string("NoneType");
-        if (std::dynamic_pointer_cast<PyBuiltinFunction>(obj)) return std::string("builtin_function_or_method");
-        if (std::dynamic_pointer_cast<PyFunction>(obj)) return std::string("function");
-        // По умолчанию:
-        return std::string("object");
-};
+
  
-Executor::Executor() : scopes(), reporter() {
+Executor::Executor(ExecutorOptions opts) : scopes(), options(opts), reporter() {
     
     TypeRegistry::instance().registerBuiltins();
 
-    auto print_fn = std::make_shared<PyBuiltinFunction>(
+    auto print_fn = make_ref<PyBuiltinFunction>(
         "print",
         [](const std::vector<ObjectPtr>& args) {
             for (auto &a : args) {
                 std::cout << a->repr() << " ";
             }
             std::cout << std::endl;
-            return std::make_shared<PyNone>();
+            return py_none();
         }
     );
     
     scopes.insert(Symbol{"print", SymbolType::BuiltinFunction, print_fn, nullptr});
 
     // range(n) → [0,1,…,n-1]
-    auto range_fn = std::make_shared<PyBuiltinFunction>(
+    auto range_fn = make_ref<PyBuiltinFunction>(
         "range",
         [](const std::vector<ObjectPtr>& args) {
-            auto arg0 = std::dynamic_pointer_cast<PyInt>(args[0]);
+            auto *arg0 = kind_cast<PyInt>(args[0]);
             if (!arg0) {
                 throw RuntimeError("TypeError: range() argument must be int");
             }
-            int n = arg0->get();
-            std::vector<ObjectPtr> elems;
-            elems.reserve(n);
-            for (int i = 0; i < n; ++i) {
-                elems.push_back(std::make_shared<PyInt>(i));
+            if (!arg0->is_small()) {
+                throw RuntimeError("OverflowError: range() argument is too large");
+            }
+            int64_t n = arg0->get();
+            // Числа сразу ложатся в буфер словами — объекты PyInt не создаются
+            auto elems = make_ref<ListBuffer>();
+            elems->reserve(n > 0 ? n : 0);
+            for (int64_t i = 0; i < n; ++i) {
+                elems->push_word(ListBuffer::Strategy::Int, static_cast<uint64_t>(i));
             }
-            return std::make_shared<PyList>(std::move(elems));
+            return make_ref<PyList>(std::move(elems));
         }
     );
     scopes.insert(Symbol{"range", SymbolType::BuiltinFunction, range_fn, nullptr});
 
+    // set() / set(iterable) — множество из элементов списка, множества или символов строки
+    auto set_fn = make_ref<PyBuiltinFunction>(
+        "set",
+        [](const std::vector<ObjectPtr>& args) -> ObjectPtr {
+            if (args.size() > 1) {
+                throw RuntimeError("TypeError: set expected at most 1 argument, got "
+                    + std::to_string(args.size()));
+            }
+            if (args.empty()) {
+                return make_ref<PySet>();
+            }
+            std::vector<ObjectPtr> elems;
+            switch (args[0]->kind()) {
+                case Kind::List:
+                    elems = static_cast<PyList&>(*args[0]).elements();
+                    break;
+                case Kind::Tuple: {
+                    const auto &tuple = static_cast<PyTuple&>(*args[0]);
+                    elems.reserve(tuple.size());
+                    for (size_t i = 0; i < tuple.size(); ++i) {
+                        elems.push_back(tuple.item(i));
+                    }
+                    break;
+                }
+                case Kind::Set:
+                    elems = static_cast<PySet&>(*args[0]).getElements();
+                    break;
+                case Kind::String:
+                    for (char c : static_cast<PyString&>(*args[0]).get()) {
+                        elems.push_back(py_char(c));
+                    }
+                    break;
+                default:
+                    throw RuntimeError("TypeError: '" + deduceTypeName(args[0])
+                        + "' object is not iterable");
+            }
+            // Как и в build_set: list, dict и set нехешируемы
+            for (const auto &e : elems) {
+                Kind kind = e->kind();
+                if (kind == Kind::List || kind == Kind::Dict || kind == Kind::Set) {
+                    throw RuntimeError("TypeError: unhashable type: '" + deduceTypeName(e) + "'");
+                }
+            }
+            return make_ref<PySet>(std::move(elems));
+        }
+    );
+    scopes.insert(Symbol{"set", SymbolType::BuiltinFunction, set_fn, nullptr});
+
     // 3) len(obj) — возвращает «длину» объекта
     //    Будем поддерживать: строки, списки, словари, множества. Для всего остального — ошибка.
-    auto len_fn = std::make_shared<PyBuiltinFunction>(
+    auto len_fn = make_ref<PyBuiltinFunction>(
         "len",
         [](const std::vector<ObjectPtr>& args) {
             // Проверяем, что передали ровно 1 аргумент
@@ -105,36 +111,31 @@ Executor::Executor() : scopes(), reporter() {
                 throw RuntimeError("TypeError: len() takes exactly one argument (" +
                     std::to_string(args.size()) + " given)");
             }
-            ObjectPtr obj = args[0];
-            // 1) Если строка
-            if (auto s = std::dynamic_pointer_cast<PyString>(obj)) {
-                int length = static_cast<int>(s->get().size());
-                return std::make_shared<PyInt>(length);
-            }
-            // 2) Если список
-            if (auto lst = std::dynamic_pointer_cast<PyList>(obj)) {
-                int length = static_cast<int>(lst->getElements().size());
-                return std::make_shared<PyInt>(length);
-            }
-            // 3) Если словарь
-            if (auto d = std::dynamic_pointer_cast<PyDict>(obj)) {
-                // repr() у словаря даёт что-то вроде "{...}", но чтобы взять
-                // реальное количество элементов, лучше обратиться к внутреннему контейнеру.
-                int length = static_cast<int>(d->getItems().size());
-                return std::make_shared<PyInt>(length);
-            }
-            // 4) Если множество
-            if (auto st = std::dynamic_pointer_cast<PySet>(obj)) {
-                int length = static_cast<int>(st->getElements().size());
-                return std::make_shared<PyInt>(length);
+            const ObjectPtr &obj = args[0];
+            // Длина строки и любого контейнера хранится готовой — O(1)
+            switch (obj->kind()) {
+                case Kind::String:
+                    return py_int(static_cast<int64_t>(static_cast<PyString&>(*obj).size()));
+                case Kind::List:
+                    return py_int(static_cast<int>(static_cast<PyList&>(*obj).size()));
+                case Kind::Tuple:
+                    return py_int(static_cast<int>(static_cast<PyTuple&>(*obj).size()));
+                case Kind::Dict:
+                    return py_int(static_cast<int>(static_cast<PyDict&>(*obj).getItems().size()));
+                case Kind::Set:
+                    return py_int(static_cast<int>(static_cast<PySet&>(*obj).getElements().size()));
+                default:
+                    break;
             }
-            // 5) Если всё остальное — бросаем TypeError
+            // Всё остальное — TypeError
             std::string tname;
-            if (std::dynamic_pointer_cast<PyInt>(obj))    tname = "int";
-            else if (std::dynamic_pointer_cast<PyFloat>(obj))  tname = "float";
-            else if (std::dynamic_pointer_cast<PyBool>(obj))   tname = "bool";
-            else if (std::dynamic_pointer_cast<PyFunction>(obj)) tname = "function";
-            else tname = "object";
+            switch (obj->kind()) {
+                case Kind::Int:      tname = "int"; break;
+                case Kind::Float:    tname = "float"; break;
+                case Kind::Bool:     tname = "bool"; break;
+                case Kind::Function: tname = "function"; break;
+                default:             tname = "object"; break;
+            }
             throw RuntimeError("TypeError: object of type '" + tname + "' has no len()");
         }
     );
@@ -147,131 +148,148 @@ Executor::Executor() : scopes(), reporter() {
     //     - для строк — вернём по символам (каждый символ как строку длины 1)
     //     - для множеств — по repr() каждого элемента
     //     - для всего остального — пустой список
-    auto dir_fn = std::make_shared<PyBuiltinFunction>(
+    auto dir_fn = make_ref<PyBuiltinFunction>(
         "dir",
         [](const std::vector<ObjectPtr>& args) {
             if (args.size() != 1) {
                 throw RuntimeError("TypeError: dir() takes exactly one argument (" +
                     std::to_string(args.size()) + " given)");
             }
-            ObjectPtr obj = args[0];
+            const ObjectPtr &obj = args[0];
             // Результируемый вектор строк
             std::vector<ObjectPtr> names;
 
-            // 1) Если список — возвращаем индексы в виде строк
-            if (auto lst = std::dynamic_pointer_cast<PyList>(obj)) {
-                int n = static_cast<int>(lst->getElements().size());
-                for (int i = 0; i < n; ++i) {
-                    names.push_back(std::make_shared<PyString>(std::to_string(i)));
-                }
-                return std::make_shared<PyList>(std::move(names));
-            }
-            // 2) Если словарь — возвращаем repr() ключей
-            if (auto d = std::dynamic_pointer_cast<PyDict>(obj)) {
-                // Получаем пары ключ->значение, но нам нужны лишь ключи
-                for (auto &kv : d->getItems()) {
-                    ObjectPtr keyObj = kv.first;
-                    // Приводим ключ к repr() и кладём как PyString
-                    names.push_back(std::make_shared<PyString>(keyObj->repr()));
-                }
-                return std::make_shared<PyList>(std::move(names));
-            }
-            // 3) Если строка — возвращаем по одному символу
-            if (auto s = std::dynamic_pointer_cast<PyString>(obj)) {
-                const std::string &str = s->get();
-                for (char c : str) {
-                    std::string ch(1, c);
-                    names.push_back(std::make_shared<PyString>(ch));
-                }
-                return std::make_shared<PyList>(std::move(names));
-            }
-            // 4) Если множество — возвращаем repr() каждого элемента
-            if (auto st = std::dynamic_pointer_cast<PySet>(obj)) {
-                for (auto &el : st->getElements()) {
-                    names.push_back(std::make_shared<PyString>(el->repr()));
+            switch (obj->kind()) {
+                // 1) Список — индексы в виде строк
+                case Kind::List: {
+                    int n = static_cast<int>(static_cast<PyList&>(*obj).size());
+                    names.reserve(n);
+                    for (int i = 0; i < n; ++i) {
+                        names.push_back(make_ref<PyString>(std::to_string(i)));
+                    }
+                    break;
                 }
-                return std::make_shared<PyList>(std::move(names));
+                // 2) Словарь — repr() ключей
+                case Kind::Dict:
+                    for (auto &kv : static_cast<PyDict&>(*obj).getItems()) {
+                        names.push_back(make_ref<PyString>(kv.first->repr()));
+                    }
+                    break;
+                // 3) Строка — по одному символу
+                case Kind::String:
+                    for (char c : static_cast<PyString&>(*obj).get()) {
+                        names.push_back(py_char(c));
+                    }
+                    break;
+                // 4) Множество — repr() каждого элемента
+                case Kind::Set:
+                    for (auto &el : static_cast<PySet&>(*obj).getElements()) {
+                        names.push_back(make_ref<PyString>(el->repr()));
+                    }
+                    break;
+                // 5) Во всех остальных случаях — пустой список
+                default:
+                    break;
             }
-            // 5) Во всех остальных случаях возвращаем пустой список
-            return std::make_shared<PyList>(std::vector<ObjectPtr>{});
+            return make_ref<PyList>(std::move(names));
         }
     );
     scopes.insert(Symbol{"dir", SymbolType::BuiltinFunction, dir_fn, nullptr});
 
-    // 5) enumerate(iterable) — возвращаем список пар [index, element].
-    //    Реализуем для списков, строк и словарей (по ключам). Во всех остальных — TypeError.
-    auto enumerate_fn = std::make_shared<PyBuiltinFunction>(
+    // 5) enumerate(iterable) — возвращаем список пар (index, element).
+    //    Реализуем для списков, кортежей, строк и словарей (по ключам). Во всех остальных — TypeError.
+    auto enumerate_fn = make_ref<PyBuiltinFunction>(
         "enumerate",
         [](const std::vector<ObjectPtr>& args) {
             if (args.size() != 1) {
                 throw RuntimeError("TypeError: enumerate() takes exactly one argument (" +
                     std::to_string(args.size()) + " given)");
             }
-            ObjectPtr obj = args[0];
-            std::vector<ObjectPtr> result;  // Будем класть сюда серии [индекс, элемент]
-
-            // 1) Если список
-            if (auto lst = std::dynamic_pointer_cast<PyList>(obj)) {
-                const auto &elems = lst->getElements();
-                for (size_t i = 0; i < elems.size(); ++i) {
-                    // Составляем пару [ i, elems[i] ]
-                    std::vector<ObjectPtr> pairVec;
-                    pairVec.reserve(2);
-                    pairVec.push_back(std::make_shared<PyInt>(static_cast<int>(i)));
-                    pairVec.push_back(elems[i]);
-                    // Сами пары будем хранить как PyList из двух элементов
-                    result.push_back(std::make_shared<PyList>(std::move(pairVec)));
+            const ObjectPtr &obj = args[0];
+            std::vector<ObjectPtr> result;  // Будем класть сюда пары (индекс, элемент)
+
+            // Пара — кортеж (i, элемент): одно выделение памяти, обычно из свободного списка
+            auto add_pair = [&result](size_t i, ObjectPtr element) {
+                result.push_back(PyTuple::make({py_int(static_cast<int64_t>(i)), std::move(element)}));
+            };
+
+            switch (obj->kind()) {
+                // 1) Список
+                case Kind::List: {
+                    const PyList &list = static_cast<PyList&>(*obj);
+                    result.reserve(list.size());
+                    for (size_t i = 0; i < list.size(); ++i) {
+                        add_pair(i, list.item(i));
+                    }
+                    return make_ref<PyList>(std::move(result));
                 }
-                return std::make_shared<PyList>(std::move(result));
-            }
-            // 2) Если строка — итерируем по символам
-            if (auto s = std::dynamic_pointer_cast<PyString>(obj)) {
-                const std::string &str = s->get();
-                for (size_t i = 0; i < str.size(); ++i) {
-                    std::vector<ObjectPtr> pairVec;
-                    pairVec.reserve(2);
-                    pairVec.push_back(std::make_shared<PyInt>(static_cast<int>(i)));
-                    // Второй элемент — символ как PyString
-                    pairVec.push_back(std::make_shared<PyString>(std::string(1, str[i])));
-                    result.push_back(std::make_shared<PyList>(std::move(pairVec)));
+                // 1a) Кортеж
+                case Kind::Tuple: {
+                    const PyTuple &tuple = static_cast<PyTuple&>(*obj);
+                    result.reserve(tuple.size());
+                    for (size_t i = 0; i < tuple.size(); ++i) {
+                        add_pair(i, tuple.item(i));
+                    }
+                    return make_ref<PyList>(std::move(result));
                 }
-                return std::make_shared<PyList>(std::move(result));
-            }
-            // 3) Если словарь — итерируем по ключам, возвращаем пары [index, key]
-            if (auto d = std::dynamic_pointer_cast<PyDict>(obj)) {
-                const auto &items = d->getItems();
-                size_t idx = 0;
-                for (auto &kv : items) {
-                    ObjectPtr keyObj = kv.first;
-                    std::vector<ObjectPtr> pairVec;
-                    pairVec.reserve(2);
-                    pairVec.push_back(std::make_shared<PyInt>(static_cast<int>(idx)));
-                    pairVec.push_back(keyObj);
-                    result.push_back(std::make_shared<PyList>(std::move(pairVec)));
-                    ++idx;
+                // 2) Строка — по символам (символ как PyString)
+                case Kind::String: {
+                    const std::string &str = static_cast<PyString&>(*obj).get();
+                    result.reserve(str.size());
+                    for (size_t i = 0; i < str.size(); ++i) {
+                        add_pair(i, py_char(str[i]));
+                    }
+                    return make_ref<PyList>(std::move(result));
                 }
-                return std::make_shared<PyList>(std::move(result));
+                // 3) Словарь — по ключам, пары [index, key]
+                case Kind::Dict: {
+                    const auto &items = static_cast<PyDict&>(*obj).getItems();
+                    result.reserve(items.size());
+                    for (size_t i = 0; i < items.size(); ++i) {
+                        add_pair(i, items[i].first);
+                    }
+                    return make_ref<PyList>(std::move(result));
+                }
+                default:
+                    break;
             }
             // 4) В остальных случаях — ошибка типа
             std::string tname;
-            if (std::dynamic_pointer_cast<PyInt>(obj))    tname = "int";
-            else if (std::dynamic_pointer_cast<PyFloat>(obj))  tname = "float";
-            else if (std::dynamic_pointer_cast<PyBool>(obj))   tname = "bool";
-            else tname = "object";
+            switch (obj->kind()) {
+                case Kind::Int:   tname = "int"; break;
+                case Kind::Float: tname = "float"; break;
+                case Kind::Bool:  tname = "bool"; break;
+                default:          tname = "object"; break;
+            }
             throw RuntimeError("TypeError: '" + tname + "' object is not iterable");
         }
     );
     scopes.insert(Symbol{"enumerate", SymbolType::BuiltinFunction, enumerate_fn, nullptr});
 }
 
-std::shared_ptr<Object> Executor::evaluate(Expression &expr) {
+ObjectPtr Executor::evaluate(Expression &expr) {
     expr.accept(*this);
     return pop_value();
 }
 
 void Executor::execute(TransUnit &unit) {
+    // Перед исполнением один раз раскладываем имена по областям видимости:
+    // локальные слоты, ячейки замыканий или глобальная таблица (см. resolver.hpp).
+    Resolver resolver;
+    resolver.resolve(unit);
+
     try {
-        unit.accept(*this);
+        if (options.stackless) {
+            // --stackless: компилируем модуль и все функции в байткод
+            // и исполняем его в одном цикле (см. run_code в vm.cpp)
+            Compiler compiler(reporter, options.tailCalls);
+            auto module = compiler.compile(unit);
+            if (!reporter.has_errors()) {
+                run_code(*module, 0);
+            }
+        } else {
+            unit.accept(*this);
+        }
     }
     catch (const RuntimeError &err) {
         std::cerr << "RuntimeError: " << err.what() << "\n";
@@ -335,41 +353,19 @@ void Executor::visit(FuncDecl &node) {
             default_values.push_back(value);
         } else {
             // Если вдруг передано nullptr, просто кладём PyNone
-            default_values.push_back(std::make_shared<PyNone>());
-        }
-    }
-
-    // 4) Создаём объект пользовательской функции,
-    //    передаём ему:
-    //      - имя
-    //      - указатель на AST-узел FuncDecl (чтобы знать тело функции)
-    //      - «лексическое окружение» (environment) — таблицу символов текущего scope
-    //      - список имён позиционных параметров
-    //      - вектор default-значений
-    auto fn_obj = std::make_shared<PyFunction>(
-        node.name,
-        &node,
-        scopes.currentTable(),  // лексическое окружение, чтобы функция могла замыкать переменные
-        node.posParams,
-        std::move(default_values)
-    );
-
-    // 5) Вставляем этот объект в таблицу символов текущей области видимости
-    //    и помечаем тип SymbolType::Function.
-    Symbol sym;
-    sym.name  = node.name;
-    sym.type  = SymbolType::Function;
-    sym.value = fn_obj;
-    sym.decl  = &node;
-
-    if (auto existing = scopes.lookup_local(node.name)) {
-        // Если имя функции уже было в этом же scope (например, другая функция
-        // с тем же именем), перезаписываем символ
-        *existing = sym;
-    } else {
-        scopes.insert(sym);
+            default_values.push_back(py_none());
+        }
     }
 
+    // 4) Создаём объект пользовательской функции (см. make_function):
+    //    он запомнит FuncDecl, default-значения и ячейки замыкания.
+    auto fn_obj = make_function(node, std::move(default_values));
+
+    // 5) Записываем функцию под её именем туда, куда указал резолвер:
+    //    в локальный слот объемлющей функции или в таблицу символов модуля
+    //    (с типом SymbolType::Function; если имя уже было — перезаписываем).
+    store_name(node.nameRef, node.name, fn_obj, SymbolType::Function, &node);
+
     // Мы явно НЕ enter_scope() и не leave_scope(), 
     // потому что мы не входили «внутрь» тела функции в момент объявления.
     // Фактический «вход в тело» произойдет, когда кто-то вызовет эту функцию.
@@ -382,6 +378,12 @@ void Executor::visit(BlockStat &node) {
         if (reporter.has_errors()) {
             return;
         }
+
+        // return/break/continue — остаток блока не выполняем,
+        // запись о завершении уходит наверх к циклу или вызову функции.
+        if (!completion.is_normal()) {
+            return;
+        }
     }
 }
 
@@ -397,7 +399,7 @@ void Executor::visit(ExprStat &node) {
         // Одно значение появилось в valueStack
         // Сбрасываем его (мы не используем результат выражения дальше, 
         // т.к. это просто «выражение-инструкция»).
-        pop_value();
+        pop();
     }
 }
 
@@ -414,30 +416,17 @@ void Executor::visit(AssignStat &node) {
     } else {
         // Если вдруг node.right == nullptr, значит присваивается «ничего» —
         // можно считать, что это эквивалентно None.
-        push_value(std::make_shared<PyNone>());
+        push_value(py_none());
     }
     // Теперь на вершине стека хранится ObjectPtr, которое мы собираемся присвоить
-    ObjectPtr right_val = pop_value();
+    Value right_val = pop();
 
     // 2) Разбираем левую часть:
     // 2.1) Если просто идентификатор: IdExpr
     if (auto id = dynamic_cast<IdExpr*>(node.left.get())) {
-        std::string var = id->name;
-
-        // Проверяем, есть ли уже локальный символ с таким именем:
-        if (!scopes.lookup_local(var)) {
-            // Если нет — создаём новую переменную в этом scope
-            Symbol sym;
-            sym.name  = var;
-            sym.type  = SymbolType::Variable;
-            sym.value = nullptr;     // пока просто задаём nullptr, заполнится ниже
-            sym.decl  = &node;
-            scopes.insert(sym);
-        }
-        // Теперь у нас точно есть Symbol* в текущем локальном scope:
-        Symbol *sym = scopes.lookup_local(var);
-        // Кладём внутрь переменной вычисленное значение:
-        sym->value = right_val;
+        // Кладём вычисленное значение туда, куда указал резолвер
+        // (локальный слот, ячейка или таблица символов модуля):
+        store_name(id->ref, id->name, right_val, SymbolType::Variable, &node);
         return;
     }
 
@@ -460,7 +449,7 @@ void Executor::visit(AssignStat &node) {
 
         // Пример (предположим, что мы добавили виртуальный __setitem__ в Object):
         try {
-            base->__setitem__(index, right_val);
+            base->__setitem__(index, right_val.object());
         }
         catch (const RuntimeError &err) {
             // Если базовый объект не поддерживает __setitem__, __setitem__ 
@@ -476,13 +465,16 @@ void Executor::visit(AssignStat &node) {
         attr->obj->accept(*this);
         ObjectPtr base = pop_value();
 
-        // Имя атрибута:
-        std::string field = attr->name;
+        // Имя атрибута (интернированное, см. py_intern):
+        if (!attr->internedName) {
+            attr->internedName = py_intern(attr->name).get();
+        }
+        Ref<PyString> field(attr->internedName);
 
         // Если у нас в Object есть виртуальный метод setattr(name, ObjectPtr),
         // то просто вызываем его. Если нет — бросаем ошибку.
         try {
-            base->__setattr__(field, right_val);
+            set_attribute(base, field, right_val.object(), attr->cache, attr->line);
         }
         catch (const RuntimeError &err) {
             throw;
@@ -499,16 +491,43 @@ void Executor::visit(AssignStat &node) {
 }
 
 void Executor::visit(IdExpr &node) {
-    // При встрече идентификатора нужно извлечь его текущее значение из таблицы символов
-    // и сохранить его в «текущем значении» (либо на стек выражений, в зависимости от реализации).
+    // Где лежит значение — решил резолвер: локальный слот, ячейка или таблица символов
+    push(load_name(node.ref, node.name, node.line));
+}
+
+Value Executor::load_name(const NameRef &ref, const std::string &name, int line) {
+    // Локальная переменная функции — один индекс в плоском массиве кадра
+    if (ref.scope == NameScope::Local) {
+        const Value &value = local_slots[frames.back().base + ref.slot];
+        if (value.empty()) {
+            throw RuntimeError(
+                "Line " + std::to_string(line) + ": local variable '" + name + "' referenced before assignment"
+            );
+        }
+        return value;
+    }
+
+    // Захваченная переменная — ячейка кадра (своя или из замыкания)
+    if (ref.scope == NameScope::Cell) {
+        const ObjectPtr &value = frames.back().cells[ref.slot]->value;
+        if (!value) {
+            throw RuntimeError(
+                "Line " + std::to_string(line) + ": free variable '" + name
+                + "' referenced before assignment in enclosing scope"
+            );
+        }
+        return value;
+    }
+
+    // Глобальное имя: ищем в таблице символов модуля (там же встроенные функции).
 
     // 1) Ищем символ в текущем (или во внешних) областях видимости
-    Symbol* sym = scopes.lookup(node.name);
+    Symbol* sym = scopes.lookup(name);
 
     // 2) Если символ не найден — это ошибка времени выполнения
     if (!sym) {
         throw RuntimeError(
-            "Line " + std::to_string(node.line) + ": name '" + node.name + "' is not defined"
+            "Line " + std::to_string(line) + ": name '" + name + "' is not defined"
         );
     }
 
@@ -516,111 +535,57 @@ void Executor::visit(IdExpr &node) {
     //    то это тоже ошибка (переменная объявлена, но не инициализирована).
     if (!sym->value) {
         throw RuntimeError(
-            "Line " + std::to_string(node.line) + ": variable '" + node.name + "' referenced before assignment"
+            "Line " + std::to_string(line) + ": variable '" + name + "' referenced before assignment"
         );
     }
 
-    // 4) Извлекаем объект и сохраняем его как «результат» этого узла AST.
-    //    Предполагаем, что в Executor есть метод push_value, который запоминает
-    //    результат вычисления текущего поддерева.
-    push_value(sym->value);
+    // 4) Возвращаем найденный объект
+    return sym->value;
 }
 
-
-void Executor::visit(BinaryExpr &node) {
-    // 1) Вычисляем левый операнд
-    node.left->accept(*this);
-    ObjectPtr leftVal = pop_value();
-
-    // 2) Вычисляем правый операнд
-    node.right->accept(*this);
-    ObjectPtr rightVal = pop_value();
-
-    // 3) Обрабатываем оператор
-    const std::string &op = node.op;
-    ObjectPtr result;
-
-    if (op == "+") {
-        result = leftVal->__add__(rightVal);
-        push_value(result);
-        return;
-    }
-    else if (op == "-") {
-        result = leftVal->__sub__(rightVal);
-        push_value(result);
-        return;
-    }
-    else if (op == "*") {
-        result = leftVal->__mul__(rightVal);
-        push_value(result);
+void Executor::store_name(const NameRef &ref, const std::string &name,
+                          Value value, SymbolType type, ASTNode *decl) {
+    if (ref.scope == NameScope::Local) {
+        local_slots[frames.back().base + ref.slot] = std::move(value);
         return;
     }
-    else if (op == "/") {
-        result = leftVal->__div__(rightVal);
-        push_value(result);
+    if (ref.scope == NameScope::Cell) {
+        frames.back().cells[ref.slot]->value = value.object();
         return;
     }
 
-    // Сравнения
-    else if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=") {
-        std::string lhs = leftVal->repr();
-        std::string rhs = rightVal->repr();
-        bool comp = false;
-        if (op == "==") comp = (lhs == rhs);
-        else if (op == "!=") comp = (lhs != rhs);
-        else if (op == "<") comp = (lhs < rhs);
-        else if (op == ">") comp = (lhs > rhs);
-        else if (op == "<=") comp = (lhs <= rhs);
-        else if (op == ">=") comp = (lhs >= rhs);
-        push_value(std::make_shared<PyBool>(comp));
+    // Глобальное имя: проверяем, есть ли уже символ с таким именем в таблице модуля
+    if (auto existing = scopes.lookup_local(name)) {
+        existing->value = value.object();
+        if (type != SymbolType::Variable) {
+            // def/class поверх существующего имени перезаписывают символ целиком
+            existing->type = type;
+            existing->decl = decl;
+        }
         return;
     }
+    // Если нет — создаём новую переменную
+    Symbol sym;
+    sym.name  = name;
+    sym.type  = type;
+    sym.value = value.object();
+    sym.decl  = decl;
+    scopes.insert(sym);
+}
 
-    // Логические
-    else if (op == "and" || op == "or") {
 
-        bool leftTruthy = is_truthy(leftVal);
-        if (op == "and") {
-            if (!leftTruthy) {
-                push_value(leftVal);
-                return;
-            } else {
-                push_value(rightVal);
-                return;
-            }
-        } else {
-            if (leftTruthy) {
-                push_value(leftVal);
-                return;
-            } else {
-                push_value(rightVal);
-                return;
-            }
-        }
-    }
+void Executor::visit(BinaryExpr &node) {
+    // 1) Вычисляем левый операнд
+    node.left->accept(*this);
+    Value leftVal = pop();
 
-    // in / not in
-    else if (op == "in" || op == "not in") {
-        bool containsResult = false;
-        try {
-            containsResult = rightVal->__contains__(leftVal);
-        } catch (const RuntimeError &err) {
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " TypeError: " + err.what()
-            );
-        }
-        if (op == "not in") {
-            containsResult = !containsResult;
-        }
-        push_value(std::make_shared<PyBool>(containsResult));
-        return;
-    }
+    // 2) Вычисляем правый операнд
+    node.right->accept(*this);
+    Value rightVal = pop();
 
-    throw RuntimeError(
-        "Line " + std::to_string(node.line)
-        + ": unsupported binary operator '" + op + "'"
-    );
+    // 3) Обрабатываем оператор (общая с байткодом семантика — binary_op);
+    //    над int/float/bool операнды и результат остаются Value без объектов
+    push(binary_op(node.op, leftVal, rightVal, node.line));
 }
 
 
@@ -636,75 +601,10 @@ void Executor::visit(UnaryExpr &node) {
         );
     }
 
-    ObjectPtr operandVal = pop_value();
-
-    const std::string &op = node.op;
-    // Определим «тип» объекта в виде строки для сообщений об ошибках
+    Value operandVal = pop();
 
-    // --- unary + ---
-    if (op == "+") {
-        // В Python «+x» достаточно просто вернуть x, если x – число или булево
-        if (auto pint = std::dynamic_pointer_cast<PyInt>(operandVal)) {
-            // Можно вернуть тот же объект или создать новый – оставим тот же
-            push_value(pint);
-            return;
-        }
-        if (auto pfloat = std::dynamic_pointer_cast<PyFloat>(operandVal)) {
-            push_value(pfloat);
-            return;
-        }
-        if (auto pbool = std::dynamic_pointer_cast<PyBool>(operandVal)) {
-            // Булево тоже интерпретируется как число 0/1 → возвращаем PyInt или PyBool? Лучше PyInt
-            int intval = pbool->get() ? 1 : 0;
-            push_value(std::make_shared<PyInt>(intval));
-            return;
-        }
-        // Для остальных типов + недопустимо
-        std::string tname = deduceTypeName(operandVal);
-        throw RuntimeError(
-            "Line " + std::to_string(node.line)
-            + " TypeError: bad operand type for unary +: '" + tname + "'"
-        );
-    }
-
-    // --- unary - ---
-    else if (op == "-") {
-        if (auto pint = std::dynamic_pointer_cast<PyInt>(operandVal)) {
-            push_value(std::make_shared<PyInt>(- pint->get()));
-            return;
-        }
-        if (auto pfloat = std::dynamic_pointer_cast<PyFloat>(operandVal)) {
-            push_value(std::make_shared<PyFloat>(- pfloat->get()));
-            return;
-        }
-        if (auto pbool = std::dynamic_pointer_cast<PyBool>(operandVal)) {
-            // Булево как число: True → 1, False → 0
-            int intval = pbool->get() ? 1 : 0;
-            push_value(std::make_shared<PyInt>(- intval));
-            return;
-        }
-        // Все остальное – ошибка
-        std::string tname = deduceTypeName(operandVal);
-        throw RuntimeError(
-            "Line " + std::to_string(node.line)
-            + " TypeError: bad operand type for unary -: '" + tname + "'"
-        );
-    }
-
-    // --- logical not ---
-    else if (op == "not") {
-        bool truth = is_truthy(operandVal);
-        push_value(std::make_shared<PyBool>(!truth));
-        return;
-    }
-
-    // --- недопусточный оператор ---
-    else {
-        throw RuntimeError(
-            "Line " + std::to_string(node.line)
-            + " SyntaxError: invalid unary operator '" + op + "'"
-        );
-    }
+    // 2) Применяем оператор: +, - или not
+    push(unary_op(node.op, operandVal, node.line));
 }
 
 
@@ -723,12 +623,19 @@ void Executor::visit(CallExpr &node) {
         args.push_back(pop_value());
     }
 
-    // 3) Теперь нам нужно проверить, «вызываемый объект» (callee) действительно
+    // 3) Вызываем (см. call_object) и кладём результат на стек
+    push_value(call_object(callee, args, node.line));
+}
+
+ObjectPtr Executor::call_object(const ObjectPtr &callee,
+                                              const std::vector<ObjectPtr> &args,
+                                              int line) {
+    // Теперь нам нужно проверить, «вызываемый объект» (callee) действительно
     //    является вызываемым. В Python любая функция (builtin или user) предоставляет
     //    метод __call__. Если это не функция и вообще не вызывает __call__, бросим ошибку.
 
     // --- Сначала обрабатываем встроенные функции (PyBuiltinFunction) ---
-    if (auto builtinFn = std::dynamic_pointer_cast<PyBuiltinFunction>(callee)) {
+    if (auto builtinFn = kind_cast<PyBuiltinFunction>(callee)) {
         // Просто вызываем __call__ у встроенной функции
         // Внутри __call__ для PyBuiltinFunction уже реализована логика,
         // вывод через std::cout и возврат PyNone или любого другого объекта.
@@ -740,127 +647,18 @@ void Executor::visit(CallExpr &node) {
             // Если внутри встроенной функции произошла ошибка,
             // просто пробрасываем дальше с указанием строки.
             throw RuntimeError(
-                "Line " + std::to_string(node.line)
+                "Line " + std::to_string(line)
                 + " " + err.what()
             );
         }
-        // Кладём результат на стек
-        push_value(result);
-        return;
+        return result;
     }
 
     // --- Теперь проверим, может быть это пользовательская функция (PyFunction) ---
-    if (auto userFn = std::dynamic_pointer_cast<PyFunction>(callee)) {
-        // Извлекаем AST-узел FuncDecl, который описывает тело функции
-        FuncDecl *decl = userFn->getDecl();
-
-        // 3.1) Проверяем число аргументов:
-        size_t provided = args.size();
-        size_t requiredPos = decl->posParams.size();
-        size_t defaultCount = decl->defaultParams.size();
-
-        // Если передали меньше, чем позиционных (обязательных) параметров — ошибка
-        if (provided < requiredPos) {
-            size_t missing = requiredPos - provided;
-            // Соберём имена тех параметров, которые не были переданы
-            std::vector<std::string> missingNames;
-            for (size_t i = provided; i < requiredPos; ++i) {
-                missingNames.push_back("'" + decl->posParams[i] + "'");
-            }
-            std::string howMany = (missing == 1 ? "1 required positional argument" : 
-                                   std::to_string(missing) + " required positional arguments");
-            std::string namesList;
-            // Соединяем имена через «and» (как в Python)
-            if (missingNames.size() == 1) {
-                namesList = missingNames[0];
-            } else {
-                for (size_t i = 0; i < missingNames.size(); ++i) {
-                    namesList += missingNames[i];
-                    if (i + 1 < missingNames.size())
-                        namesList += " and ";
-                }
-            }
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " TypeError: " + decl->name + "() missing " 
-                + howMany + ": " + namesList
-            );
-        }
-
-        // Если передали больше, чем позиционных + default, тоже ошибка
-        if (provided > requiredPos + defaultCount) {
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " TypeError: " + decl->name + "() takes from " 
-                + std::to_string(requiredPos) + " to " 
-                + std::to_string(requiredPos + defaultCount) 
-                + " positional arguments but " + std::to_string(provided) 
-                + " were given"
-            );
-        }
-
-        // 3.2) Создаём новую таблицу символов, «дочернюю» от лексического окружения.
-        //      В ней будут локальные переменные и параметры функции.
-        scopes.enter_scope();
-
-        // 3.3) Сначала «привязываем» все позиционные параметры:
-        //      Позиционные параметры — это decl->posParams[i], i = 0..requiredPos-1.
-        for (size_t i = 0; i < requiredPos; ++i) {
-            Symbol sym;
-            sym.name = decl->posParams[i];
-            sym.type = SymbolType::Parameter;
-            sym.value = args[i];
-            sym.decl = decl; // чтобы знать, что это параметр этой функции
-            scopes.insert(sym);
-        }
-
-        // 3.4) Теперь обрабатываем параметры с default-значениями.
-        //      decl->defaultParams — вектор пар (имя параметра, AST-узел Expression),
-        //      а userFn хранит уже вычисленные default-значения в том же порядке
-        //      (в userFn->getDefaultValues()).
-        //      Если для default-параметра i передан аргумент (то есть provided > requiredPos + i),
-        //      мы используем args[requiredPos + i], иначе — defaultValues[i].
-        const auto &defParams = decl->defaultParams;                // в AST
-        const auto &defValues = userFn->getDefaultValues();         // в PyFunction
-        for (size_t i = 0; i < defParams.size(); ++i) {
-            const std::string &paramName = defParams[i].first;
-            ObjectPtr valueToBind;
-            size_t argIndex = requiredPos + i;
-            if (argIndex < provided) {
-                // Был передан позиционный аргумент, «перекрывающий» default
-                valueToBind = args[argIndex];
-            } else {
-                // Позиционные кончились — используем заранее вычисленное default
-                valueToBind = defValues[i];
-            }
-            Symbol sym;
-            sym.name = paramName;
-            sym.type = SymbolType::Parameter;
-            sym.value = valueToBind;
-            sym.decl = decl;
-            scopes.insert(sym);
-        }
-
-        // 4) Теперь выполняем тело функции. Если внутри встретится ReturnStat,
-        //    мы из visit(ReturnStat) кинем ReturnException, и здесь его поймаем.
-        ObjectPtr returnValue = std::make_shared<PyNone>(); // по умолчанию None
-        try {
-            if (decl->body) {
-                decl->body->accept(*this);
-            }
-            // Если дошли сюда без «return», возвращаем PyNone
-        }
-        catch (const ReturnException &ret) {
-            // Если пользовательская функция вызвала return X — мы тут получим X
-            returnValue = ret.value;
-        }
-
-        // 5) В любом случае «выходим» из локальной области видимости
-        scopes.leave_scope();
-
-        // 6) Кладём полученный returnValue на стек и возвращаемся
-        push_value(returnValue);
-        return;
+    // Все вызовы пользовательских функций (и отсюда, и из PyClass::__call__)
+    // идут через один и тот же call_function этого же Executor.
+    if (auto userFn = kind_cast<PyFunction>(callee)) {
+        return call_function(*userFn, args, line);
     }
 
     // --- НИ ОДИН ИЗ ТИПОВ ВЫЗЫВАЕМЫХ ФУНКЦИЙ НЕ ПОДОШЁЛ ---
@@ -868,160 +666,323 @@ void Executor::visit(CallExpr &node) {
     // callable-реализация через переопределение __call__ в Object). Если она бросит,
     // мы «пробросим» ошибку как TypeError.
     try {
-        ObjectPtr result = callee->__call__(args);
-        push_value(result);
-        return;
+        return callee->__call__(args);
     }
     catch (const RuntimeError &err) {
         throw RuntimeError(
-            "Line " + std::to_string(node.line)
+            "Line " + std::to_string(line)
             + " TypeError: " + err.what()
         );
     }
 }
 
-// Не забываем: внутри Visit(ReturnStat &node) нужно бросать ReturnException
-// чтобы «прерваться» и вернуть нужное значение:
-void Executor::visit(ReturnStat &node) {
-    // Если есть выражение, вычисляем его; иначе return без значения → None
-    if (node.expr) {
-        node.expr->accept(*this);
-        ObjectPtr retVal = pop_value();
-        throw ReturnException{retVal};
-    } else {
-        throw ReturnException{ std::make_shared<PyNone>() };
-    }
-}   
+ObjectPtr Executor::call_function(PyFunction &fn,
+                                                const std::vector<ObjectPtr> &args,
+                                                int line) {
+    // Вызов — безопасная точка для сборки циклов: все живые объекты держат Ref
+    GcHeap::collect_if_due();
+
+    // 1) Кладём кадр (проверка аргументов, локальные слоты, ячейки)
+    std::vector<Value> argValues(args.begin(), args.end());
+    push_frame(fn, argValues.data(), argValues.size(), line);
+
+    // 2) Теперь выполняем тело функции. Если внутри встретится ReturnStat,
+    //    он оставит в completion Flow::Return со значением, и run_function_body его заберёт.
+    //    При ошибке всё равно снимаем кадр и освобождаем его локальные.
+    //    В режиме --stackless тело исполняет стековая машина: она продолжит
+    //    работу до возврата из этого кадра (вызов пришёл не из байткода,
+    //    а, например, из встроенной функции).
+    ObjectPtr returnValue;
+    Ref<PyFunction> tailFn;     // держит живой функцию хвостового вызова
+    try {
+        FuncDecl *decl = fn.getDecl();
+        while (true) {
+            const CodeObject *code = decl->code.get();
+            if (options.stackless && code) {
+                returnValue = run_code(*code, frames.size()).object();
+                break;
+            }
+            returnValue = run_function_body(decl);
 
-void Executor::visit(IndexExpr &node) {
-    // 1) Сначала вычисляем «базу»: obj
-    node.base->accept(*this);
-    ObjectPtr baseVal = pop_value();
+            // 2.1) return g(...) при --tail-calls: тело оставило отложенный вызов.
+            //      Кладём кадр g на место текущего и исполняем его тело здесь же —
+            //      ни кадры, ни стек C++ при хвостовой рекурсии не растут.
+            if (!tailCall.function) {
+                break;
+            }
+            TailCall next = std::move(tailCall);
+            tailCall = TailCall{};
+            argValues.assign(next.args.begin(), next.args.end());
+            push_frame(*next.function, argValues.data(), argValues.size(), next.line);
+            replace_caller_frame();
+            tailFn = std::move(next.function);
+            decl = tailFn->getDecl();
+        }
+    }
+    catch (...) {
+        tailCall = TailCall{};
+        pop_frame();
+        throw;
+    }
 
-    // 2) Затем вычисляем «индекс»: idx
-    node.index->accept(*this);
-    ObjectPtr indexVal = pop_value();
+    // 3) Снимаем кадр — локальные вызывающего остаются на своих местах
+    pop_frame();
+    return returnValue;
+}
 
-    // 3) Попробуем определить, какого типа «базовый» объект,
-    //    и применим правила Python для индексирования.
-    if (!baseVal) {
-    throw RuntimeError("Line ...: internal error: base is null");
+void Executor::push_frame(PyFunction &fn, const Value *args, size_t nargs, int line) {
+    // Извлекаем AST-узел FuncDecl, который описывает тело функции
+    FuncDecl *decl = fn.getDecl();
+
+    // Префикс сообщений об ошибках: номер строки вызова, если он известен
+    // (вызов из PyClass::__call__ строки не знает — её добавит visit(CallExpr)).
+    std::string where = line > 0 ? "Line " + std::to_string(line) + " " : "";
+
+    // 0) Глубина рекурсии ограничена (--recursion-limit): вместо падения
+    //    процесса по переполнению стека сообщаем об ошибке как Python.
+    if (frames.size() >= static_cast<size_t>(options.recursionLimit)) {
+        throw RuntimeError(where + "RecursionError: maximum recursion depth exceeded");
+    }
+
+    // 1) Проверяем число аргументов:
+    size_t provided = nargs;
+    size_t requiredPos = decl->posParams.size();
+    size_t defaultCount = decl->defaultParams.size();
+
+    // Если передали меньше, чем позиционных (обязательных) параметров — ошибка
+    if (provided < requiredPos) {
+        size_t missing = requiredPos - provided;
+        // Соберём имена тех параметров, которые не были переданы
+        std::vector<std::string> missingNames;
+        for (size_t i = provided; i < requiredPos; ++i) {
+            missingNames.push_back("'" + decl->posParams[i] + "'");
+        }
+        std::string howMany = (missing == 1 ? "1 required positional argument" : 
+                               std::to_string(missing) + " required positional arguments");
+        std::string namesList;
+        // Соединяем имена через «and» (как в Python)
+        if (missingNames.size() == 1) {
+            namesList = missingNames[0];
+        } else {
+            for (size_t i = 0; i < missingNames.size(); ++i) {
+                namesList += missingNames[i];
+                if (i + 1 < missingNames.size())
+                    namesList += " and ";
+            }
+        }
+        throw RuntimeError(
+            where + "TypeError: " + decl->name + "() missing " 
+            + howMany + ": " + namesList
+        );
     }
-    if (!indexVal) {
-    throw RuntimeError("Line ...: internal error: index is null");
+
+    // Если передали больше, чем позиционных + default, тоже ошибка
+    if (provided > requiredPos + defaultCount) {
+        throw RuntimeError(
+            where + "TypeError: " + decl->name + "() takes from " 
+            + std::to_string(requiredPos) + " to " 
+            + std::to_string(requiredPos + defaultCount) 
+            + " positional arguments but " + std::to_string(provided) 
+            + " were given"
+        );
     }
 
-    // --- 3.1) Если это строка: разрешаем только целочисленные индексы (bool → int тоже)
-    if (auto strObj = std::dynamic_pointer_cast<PyString>(baseVal)) {
-        // Проверяем, что индекс — PyInt или PyBool
-        int idx;
-        if (auto intIdx = std::dynamic_pointer_cast<PyInt>(indexVal)) {
-            idx = intIdx->get();
-        }
-        else if (auto boolIdx = std::dynamic_pointer_cast<PyBool>(indexVal)) {
-            idx = boolIdx->get() ? 1 : 0;
-        }
-        else {
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " TypeError: string indices must be integers"
-            );
+    // 2) Отводим кадру плоский участок local_slots под все его локальные
+    //    (резолвер посчитал их число в decl->nlocals; параметры — первые слоты).
+    size_t base = local_slots.size();
+    local_slots.resize(base + decl->nlocals);
+
+    // 3) Сначала «привязываем» все позиционные параметры:
+    //    Позиционные параметры — это decl->posParams[i], i = 0..requiredPos-1.
+    for (size_t i = 0; i < requiredPos; ++i) {
+        local_slots[base + i] = args[i];
+    }
+
+    // 3.1) Теперь обрабатываем параметры с default-значениями.
+    //      decl->defaultParams — вектор пар (имя параметра, AST-узел Expression),
+    //      а fn хранит уже вычисленные default-значения в том же порядке
+    //      (в fn.getDefaultValues()).
+    //      Если для default-параметра i передан аргумент (то есть provided > requiredPos + i),
+    //      мы используем args[requiredPos + i], иначе — defaultValues[i].
+    const auto &defParams = decl->defaultParams;                // в AST
+    const auto &defValues = fn.getDefaultValues();              // в PyFunction
+    for (size_t i = 0; i < defParams.size(); ++i) {
+        Value valueToBind;
+        size_t argIndex = requiredPos + i;
+        if (argIndex < provided) {
+            // Был передан позиционный аргумент, «перекрывающий» default
+            valueToBind = args[argIndex];
+        } else {
+            // Позиционные кончились — используем заранее вычисленное default
+            valueToBind = defValues[i];
+        }
+        local_slots[base + requiredPos + i] = valueToBind;
+    }
+
+    // 3.2) Ячейки кадра: сначала свои cellvars (параметр-cellvar сразу получает
+    //      значение аргумента), затем ячейки, захваченные замыканием функции.
+    Frame frame;
+    frame.function = &fn;
+    frame.base = base;
+    frame.callLine = line;
+    if (!decl->cellNames.empty()) {
+        frame.cells.reserve(decl->cellNames.size());
+        for (size_t j = 0; j < decl->ncellvars; ++j) {
+            auto cell = std::allocate_shared<Cell>(PoolAllocator<Cell>{});
+            int paramSlot = decl->cellParamSlot[j];
+            if (paramSlot >= 0) {
+                cell->value = local_slots[base + paramSlot].object();
+            }
+            frame.cells.push_back(std::move(cell));
         }
+        const auto &closure = fn.getClosure();
+        frame.cells.insert(frame.cells.end(), closure.begin(), closure.end());
+    }
+    frames.push_back(std::move(frame));
+}
 
-        const std::string &s = strObj->get();
-        int length = static_cast<int>(s.size());
+void Executor::pop_frame() {
+    local_slots.resize(frames.back().base);
+    frames.pop_back();
+}
 
-        // В Python разрешены отрицательные индексы
-        if (idx < 0) {
-            idx += length;
-        }
+void Executor::replace_caller_frame() {
+    // Новый кадр уже положен push_frame (он проверил аргументы) — переносим
+    // его локальные на место локальных вызывающего и занимаем его место в frames.
+    Frame callee = std::move(frames.back());
+    frames.pop_back();
+    Frame &caller = frames.back();
+
+    std::move(local_slots.begin() + callee.base, local_slots.end(), local_slots.begin() + caller.base);
+    local_slots.resize(local_slots.size() - (callee.base - caller.base));
+    callee.base = caller.base;
+
+    // Возвращаться хвостовой вызов будет туда же, куда вернулся бы вызывающий
+    callee.returnCode = caller.returnCode;
+    callee.returnPc = caller.returnPc;
+    callee.stackBase = caller.stackBase;
+    if (caller.initInstance) {
+        callee.initInstance = std::move(caller.initInstance);
+        callee.callLine = caller.callLine;
+    }
+    caller = std::move(callee);
+}
 
-        // Проверяем диапазон
-        if (idx < 0 || idx >= length) {
+Ref<PyFunction> Executor::make_function(FuncDecl &decl, std::vector<ObjectPtr> defaults) {
+    // Захватываем ячейки свободных переменных: резолвер записал для каждой,
+    // какая ячейка текущего (объемлющего) кадра ей соответствует.
+    std::vector<std::shared_ptr<Cell>> closure;
+    if (!decl.freeSources.empty()) {
+        if (frames.empty()) {
             throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " IndexError: string index out of range"
+                "Line " + std::to_string(decl.line)
+                + ": internal error: closure '" + decl.name + "' created outside a function"
             );
         }
-
-        // Получаем символ и возвращаем как строку длины 1
-        char c = s[idx];
-        push_value(std::make_shared<PyString>(std::string(1, c)));
-        return;
+        closure.reserve(decl.freeSources.size());
+        for (int src : decl.freeSources) {
+            closure.push_back(frames.back().cells[src]);
+        }
     }
 
-    // --- 3.2) Если это список: разрешаем целочисленные индексы (bool → int тоже)
-    if (auto listObj = std::dynamic_pointer_cast<PyList>(baseVal)) {
-        int idx;
-        if (auto intIdx = std::dynamic_pointer_cast<PyInt>(indexVal)) {
-            idx = intIdx->get();
-        }
-        else if (auto boolIdx = std::dynamic_pointer_cast<PyBool>(indexVal)) {
-            idx = boolIdx->get() ? 1 : 0;
-        }
-        else {
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " TypeError: list indices must be integers"
-            );
-        }
+    return make_ref<PyFunction>(
+        decl.name,
+        &decl,
+        scopes.currentTable(),  // таблица символов модуля — там функция ищет глобальные имена
+        this,                   // интерпретатор, который будет исполнять тело при вызове
+        decl.posParams,
+        std::move(defaults),
+        std::move(closure)
+    );
+}
 
-        int length = static_cast<int>(listObj->getElements().size());
-        if (idx < 0) {
-            idx += length;
-        }
-        if (idx < 0 || idx >= length) {
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " IndexError: list index out of range"
-            );
-        }
+ObjectPtr Executor::run_function_body(FuncDecl *decl) {
+    // Тело функции — новый контекст: циклы вызывающего кода «не видны»,
+    // так что break внутри функции вне её собственного цикла — ошибка.
+    int savedLoopDepth = loop_depth;
+    loop_depth = 0;
+    ++func_depth;
 
-        // Получаем элемент и возвращаем
-        ObjectPtr element = listObj->getElements()[idx];
-        push_value(element);
-        return;
+    try {
+        if (decl->body) {
+            decl->body->accept(*this);
+        }
+    }
+    catch (...) {
+        loop_depth = savedLoopDepth;
+        --func_depth;
+        completion = Completion{};
+        throw;
     }
 
-    // --- 3.3) Если это словарь: index может быть любым объектом.
-    if (auto dictObj = std::dynamic_pointer_cast<PyDict>(baseVal)) {
-        // Просто вызываем __getitem__; если ключа нет — KeyError бросят там
-        try {
-            ObjectPtr result = dictObj->__getitem__(indexVal);
-            push_value(result);
-            return;
-        }
-        catch (const RuntimeError &err) {
-            // Сообщение от PyDict: "KeyError: <repr(key)>"
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " " + err.what()
-            );
-        }
+    loop_depth = savedLoopDepth;
+    --func_depth;
+
+    // Если пользовательская функция вызвала return X — забираем X,
+    // если дошли до конца тела без return — возвращаем PyNone
+    ObjectPtr returnValue = py_none();
+    if (completion.flow == Flow::Return && completion.value) {
+        returnValue = std::move(completion.value);
     }
+    completion = Completion{};
+    return returnValue;
+}
 
-    // --- 3.4) Если это множество: в Python множеству нельзя делать индексирование
-    if (std::dynamic_pointer_cast<PySet>(baseVal)) {
+// ReturnStat не «прыгает» сам: он вычисляет значение и оставляет запись
+// Flow::Return, а BlockStat/циклы перестают выполняться, пока её не заберёт вызов функции.
+void Executor::visit(ReturnStat &node) {
+    if (func_depth == 0) {
         throw RuntimeError(
             "Line " + std::to_string(node.line)
-            + " TypeError: 'set' object is not subscriptable"
+            + " SyntaxError: 'return' outside function"
         );
     }
 
-    // --- 3.5) Для любых других объектов пробуем вызвать __getitem__ напрямую.
-    //        Если __getitem__ не поддерживается, он бросит RuntimeError("object is not subscriptable").
-    try {
-        ObjectPtr result = baseVal->__getitem__(indexVal);
-        push_value(result);
-        return;
+    // return f(...) при --tail-calls: вычисляем f и аргументы, но вызов
+    // откладываем — его выполнит call_function в кадре текущей функции.
+    ObjectPtr retVal;
+    if (node.tailCall && options.tailCalls) {
+        CallExpr &call = *node.tailCall;
+        call.caller->accept(*this);
+        ObjectPtr callee = pop_value();
+        std::vector<ObjectPtr> args;
+        args.reserve(call.arguments.size());
+        for (auto &argExpr : call.arguments) {
+            argExpr->accept(*this);
+            args.push_back(pop_value());
+        }
+
+        if (auto userFn = kind_cast<PyFunction>(callee)) {
+            tailCall = TailCall{Ref<PyFunction>(userFn), std::move(args), call.line};
+            completion.flow = Flow::Return;
+            completion.value = nullptr;
+            return;
+        }
+        // встроенные функции и классы вызываем как обычно
+        retVal = call_object(callee, args, call.line);
     }
-    catch (const RuntimeError &err) {
-        // Добавляем информацию о строке
-        throw RuntimeError(
-            "Line " + std::to_string(node.line)
-            + " TypeError: " + err.what()
-        );
+    // Если есть выражение, вычисляем его; иначе return без значения → None
+    else if (node.expr) {
+        node.expr->accept(*this);
+        retVal = pop_value();
+    } else {
+        retVal = py_none();
     }
+    completion.flow = Flow::Return;
+    completion.value = std::move(retVal);
+}   
+
+void Executor::visit(IndexExpr &node) {
+    // 1) Сначала вычисляем «базу»: obj
+    node.base->accept(*this);
+    ObjectPtr baseVal = pop_value();
+
+    // 2) Затем вычисляем «индекс»: idx
+    node.index->accept(*this);
+    ObjectPtr indexVal = pop_value();
+
+    // 3) Правила индексирования строк, списков, словарей и т.д. — в get_index
+    push_value(get_index(baseVal, indexVal, node.line));
 }
 
 
@@ -1040,69 +1001,12 @@ void Executor::visit(AttributeExpr &node) {
     if (!baseVal) {
     throw RuntimeError("Line ...: internal error: baseVal is null in AttributeExpr");
     }
-    // 2) Имя атрибута, которое запрашиваем.
-    const std::string &attrName = node.name;
-
-    // 3) Пытаемся получить атрибут через виртуальный метод __getattr__.
-    //    Если объект не поддерживает данный атрибут, __getattr__ бросит RuntimeError
-    //    с сообщением "object has no attribute '...'" или подобным.
-    try {
-        ObjectPtr result = baseVal->__getattr__(attrName);
-        // 4) Если всё прошло успешно, кладём найденный атрибут на стек значений
-        push_value(result);
-        return;
-    }
-    catch (const RuntimeError &err) {
-        // 5) Если __getattr__ бросил ошибку, превращаем её в TypeError с указанием строки
-        //    Python-стиль: "Line X TypeError: 'TYPE' object has no attribute 'attrName'"
-        //    Здесь err.what() уже содержит текст типа "object has no attribute 'foo'",
-        //    но лучше скорректировать, чтобы было точно в формате Python.
-        //
-        //    Сначала определим, какого «типа» объект, чтобы сообщение было понятнее.
-        std::string typeName;
-        if (std::dynamic_pointer_cast<PyInt>(baseVal)) {
-            typeName = "int";
-        }
-        else if (std::dynamic_pointer_cast<PyFloat>(baseVal)) {
-            typeName = "float";
-        }
-        else if (std::dynamic_pointer_cast<PyBool>(baseVal)) {
-            typeName = "bool";
-        }
-        else if (std::dynamic_pointer_cast<PyString>(baseVal)) {
-            typeName = "str";
-        }
-        else if (std::dynamic_pointer_cast<PyList>(baseVal)) {
-            typeName = "list";
-        }
-        else if (std::dynamic_pointer_cast<PyDict>(baseVal)) {
-            typeName = "dict";
-        }
-        else if (std::dynamic_pointer_cast<PySet>(baseVal)) {
-            typeName = "set";
-        }
-        else if (std::dynamic_pointer_cast<PyNone>(baseVal)) {
-            typeName = "NoneType";
-        }
-        else if (std::dynamic_pointer_cast<PyBuiltinFunction>(baseVal)) {
-            typeName = "builtin_function_or_method";
-        }
-        else if (std::dynamic_pointer_cast<PyFunction>(baseVal)) {
-            typeName = "function";
-        }
-        else {
-            // На всякий случай, если это какой-то свой объект
-            typeName = "object";
-        }
-
-        // Формируем текст ошибки в духе Python:
-        // "Line X TypeError: 'TYPE' object has no attribute 'attrName'"
-        throw RuntimeError(
-            "Line " + std::to_string(node.line)
-            + " TypeError: '" + typeName
-            + "' object has no attribute '" + attrName + "'"
-        );
+    // 2) Получаем атрибут через __getattr__; при ошибке get_attribute
+    //    сформирует TypeError с указанием строки и типа объекта.
+    if (!node.internedName) {
+        node.internedName = py_intern(node.name).get();
     }
+    push_value(get_attribute(baseVal, Ref<PyString>(node.internedName), node.cache, node.line));
 }
 
 
@@ -1121,7 +1025,7 @@ void Executor::visit(TernaryExpr &node) {
     }
     node.condition->accept(*this);
     // Сохраним результат в локальную переменную
-    ObjectPtr condVal = pop_value();
+    Value condVal = pop();
     
     // 2) Определяем truthiness для condVal.
     //    В Python считается «ложным»: False, 0, 0.0, "", [], {}, set(), None.
@@ -1139,9 +1043,9 @@ void Executor::visit(TernaryExpr &node) {
             );
         }
         node.trueExpr->accept(*this);
-        ObjectPtr trueResult = pop_value();
+        Value trueResult = pop();
         // Кладём результат trueExpr на стек
-        push_value(trueResult);
+        push(std::move(trueResult));
     }
     else {
         // Иначе – вычисляем falseExpr
@@ -1152,9 +1056,9 @@ void Executor::visit(TernaryExpr &node) {
             );
         }
         node.falseExpr->accept(*this);
-        ObjectPtr falseResult = pop_value();
+        Value falseResult = pop();
         // Кладём результат falseExpr на стек
-        push_value(falseResult);
+        push(std::move(falseResult));
     }
 }
 
@@ -1162,66 +1066,8 @@ void Executor::visit(TernaryExpr &node) {
 
 void Executor::visit(LiteralExpr &node) {
     // В LiteralExpr хранятся примитивные литералы: int, double, bool, string или None.
-    // Нужно распознать, какой тип литерала и положить соответствующий объект на стек.
-
-    // Предполагаем, что в классе LiteralExpr объявлено нечто вроде:
-    //   std::variant<std::monostate, int, double, bool, std::string> value;
-    // где:
-    //   - std::monostate обозначает литерал "None"
-    //   - int обозначает целое число
-    //   - double обозначает вещественное число
-    //   - bool обозначает литерал True/False
-    //   - std::string обозначает строковый литерал (без кавычек, уже распарсенный)
-
-    // Проверяем, какой вариант хранится в node.value:
-
-    // 1) None
-    if (std::holds_alternative<std::monostate>(node.value)) {
-        // Литерал None
-        ObjectPtr noneObj = std::make_shared<PyNone>();
-        push_value(noneObj);
-        return;
-    }
-
-    // 2) Целое число
-    if (std::holds_alternative<int>(node.value)) {
-        int intVal = std::get<int>(node.value);
-        ObjectPtr intObj = std::make_shared<PyInt>(intVal);
-        push_value(intObj);
-        return;
-    }
-
-    // 3) Вещественное число (float)
-    if (std::holds_alternative<double>(node.value)) {
-        double dblVal = std::get<double>(node.value);
-        ObjectPtr floatObj = std::make_shared<PyFloat>(dblVal);
-        push_value(floatObj);
-        return;
-    }
-
-    // 4) Логическое значение (bool)
-    if (std::holds_alternative<bool>(node.value)) {
-        bool boolVal = std::get<bool>(node.value);
-        ObjectPtr boolObj = std::make_shared<PyBool>(boolVal);
-        push_value(boolObj);
-        return;
-    }
-
-    // 5) Строковый литерал
-    if (std::holds_alternative<std::string>(node.value)) {
-        // Предполагаем, что парсер убрал кавычки, и здесь передана «сырая» строка.
-        std::string strVal = std::get<std::string>(node.value);
-        ObjectPtr strObj = std::make_shared<PyString>(strVal);
-        push_value(strObj);
-        return;
-    }
-
-    // Если ни один тип не подошёл (например, в variant проскочил неизвестный тип),
-    // то лучше бросить ошибку на всякий случай.
-    throw RuntimeError(
-        "Line " + std::to_string(node.line)
-        + ": unsupported literal type"
-    );
+    // Объект для литерала строит literal_value (см. operations.hpp).
+    push(literal_as_value(node));
 }
 
 void Executor::visit(PrimaryExpr &node) {
@@ -1339,13 +1185,13 @@ void Executor::visit(ListExpr &node) {
             // 2.4) На всякий случай: если вдруг есть nullptr (пустой узел),
             //      то в Python был бы синтаксический элемент вроде «[,]» без выражения.
             //      Обычно такого не бывает, но мы можем положить None, чтобы не сломаться.
-            elements.push_back(std::make_shared<PyNone>());
+            elements.push_back(py_none());
         }
     }
 
     // 3) После того, как все элементы обработаны и лежат в векторе elements,
     //    создаём объект PyList с копией (или перемещением) нашего вектора.
-    ObjectPtr listObj = std::make_shared<PyList>(std::move(elements));
+    ObjectPtr listObj = make_ref<PyList>(std::move(elements));
 
     // 4) Кладём полученный объект списка на стек значений:
     push_value(listObj);
@@ -1362,9 +1208,9 @@ void Executor::visit(DictExpr &node) {
     //  4) если во время вычисления ключей или значений или при вставке возникнет ошибка,
     //     нужно выбросить RuntimeError с указанием номера строки в стиле Python.
 
-    // 1) Создаём новый пустой словарь
-    auto dictObj = std::make_shared<PyDict>();
-
+    // 1) Вычисляем ключи и значения по порядку слева направо
+    std::vector<ObjectPtr> keysAndValues;
+    keysAndValues.reserve(node.items.size() * 2);
     // 2) Пробегаем по всем парам (ключ, значение) в узле AST
     //    Предположим, что node.items — это вектор пар:
     //       std::vector<std::pair<std::unique_ptr<Expression>, std::unique_ptr<Expression>>> items;
@@ -1401,26 +1247,12 @@ void Executor::visit(DictExpr &node) {
         ObjectPtr valueObj = pop_value();
         if (!valueObj) throw RuntimeError("Line ...: internal error: null value in dict");
 
-        // 2.3) Пробуем вставить пару (keyObj, valueObj) в dictObj.
-        //      В PyDict __setitem__ реализован так, что если ключа ещё нет, он создаётся,
-        //      а если ключ уже есть (repr совпадает), значение перезаписывается.
-        //      Возможная RuntimeError возникает, если, например, __repr__ у ключа падает
-        //      (или другие внутренние ошибки), но чаще всего всё проходит гладко.
-        try {
-            dictObj->__setitem__(keyObj, valueObj);
-        }
-        catch (const RuntimeError &err) {
-            // Если __setitem__ бросил ошибку, превращаем её в TypeError с указанием строки
-            // Формат в духе Python: "Line X TypeError: <текст_ошибки>"
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " TypeError: " + err.what()
-            );
-        }
+        keysAndValues.push_back(keyObj);
+        keysAndValues.push_back(valueObj);
     }
 
-    // 3) После того как все пары вставлены, кладём готовый словарь на стек
-    push_value(dictObj);
+    // 3) Строим словарь (build_dict) и кладём его на стек
+    push_value(build_dict(keysAndValues, node.line));
 }
 
 
@@ -1461,38 +1293,13 @@ void Executor::visit(SetExpr &node) {
                        + ": internal error: set element evaluated to null");
         }
 
-        // 2.3) Проверяем «hashability» элемента.
-        // В нашей модели list, dict и set считать «нехэшируемыми»:
-        // отбрасываем их с TypeError.
-        if (std::dynamic_pointer_cast<PyList>(elemVal)) {
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " TypeError: unhashable type: 'list'"
-            );
-        }
-        if (std::dynamic_pointer_cast<PyDict>(elemVal)) {
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " TypeError: unhashable type: 'dict'"
-            );
-        }
-        if (std::dynamic_pointer_cast<PySet>(elemVal)) {
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + " TypeError: unhashable type: 'set'"
-            );
-        }
-
-        // 2.4) Если всё в порядке, добавляем элемент во временный вектор
+        // 2.3) Добавляем элемент во временный вектор
         tempElems.push_back(elemVal);
     }
 
-    // 3) После того как все элементы вычислены и проверены, создаём новый PySet.
-    //    Конструктор PySet уберёт дубли по repr().
-    auto setObj = std::make_shared<PySet>(std::move(tempElems));
-
-    // 4) Кладём полученное множество на стек значений
-    push_value(setObj);
+    // 3) После того как все элементы вычислены, build_set проверит их hashability
+    //    и создаст новый PySet (он уберёт дубли); кладём его на стек.
+    push_value(build_set(std::move(tempElems), node.line));
 }
 
 
@@ -1535,7 +1342,7 @@ void Executor::visit(CondStat &node) {
     // 1.1) Вычисляем выражение условия
     node.condition->accept(*this);
     // Теперь на вершине стека — ObjectPtr с результатом
-    ObjectPtr condVal = pop_value();
+    Value condVal = pop();
 
     // 1.2) Проверяем truthiness
     bool condIsTrue = is_truthy(condVal);
@@ -1570,7 +1377,7 @@ void Executor::visit(CondStat &node) {
         }
         // 2.1) Вычисляем выражение elifCond
         elifCond->accept(*this);
-        ObjectPtr elifVal = pop_value();
+        Value elifVal = pop();
 
         // 2.2) Проверяем truthiness
         bool elifIsTrue = is_truthy(elifVal);
@@ -1633,7 +1440,7 @@ void Executor::visit(WhileStat &node) {
         // 2.1) Вычисляем условие node.condition
         node.condition->accept(*this);
         // После accept(...) на стеке valueStack должен оказаться результат условия
-        ObjectPtr condVal = pop_value();
+        Value condVal = pop();
 
         // 2.2) Проверяем «truthiness»
         bool condIsTrue = is_truthy(condVal);
@@ -1645,15 +1452,9 @@ void Executor::visit(WhileStat &node) {
 
         // 2.4) Иначе — условие истинно, выполняем тело цикла
         if (node.body) {
-        try {
-            node.body->accept(*this);
-        }
-        catch (const BreakException &) {
-            break;    // выходим из цикла
-        }
-        catch (const ContinueException &) {
-            continue; // переходим к следующей итерации
-        }
+            if (!run_loop_body(*node.body)) {
+                break;    // break или return — выходим из цикла
+            }
         } else {
             break;
         }
@@ -1675,21 +1476,12 @@ void Executor::visit(ForStat &node) {
     // Поддерживаем:
     // - Итерацию по спискам (PyList): каждый элемент списка присваивается переменной(ам).
     // - Итерацию по строкам (PyString): каждый символ (как строка длины 1) присваивается переменной.
-    // - Распаковку, если в node.iterators несколько имён: ожидаем, что элемент iterable будет PyList той же длины.
+    // - Итерацию по кортежам (PyTuple) — как по спискам.
+    // - Распаковку, если в node.iterators несколько имён: ожидаем, что элемент iterable будет PyTuple или PyList той же длины.
     // Для всех остальных типов бросаем TypeError: "<type> object is not iterable".
 
-    // 1) Подготовка: убедимся, что переменные-итераторы существуют в текущем (локальном) скоупе.
-    //    Если какой-либо переменной пока нет, создаём её в локальном скоупе с nullptr-значением.
-    for (const auto &varName : node.iterators) {
-        if (!scopes.lookup_local(varName)) {
-            Symbol sym;
-            sym.name = varName;
-            sym.type = SymbolType::Variable;
-            sym.value = nullptr;
-            sym.decl = &node;  // для связывания с этим AST-узлом
-            scopes.insert(sym);
-        }
-    }
+    // 1) Переменные-итераторы записываем через store_name по привязкам резолвера
+    //    (node.iteratorRefs): локальный слот, ячейка или таблица символов модуля.
 
     // 2) Вычислим выражение iterable.
     if (!node.iterable) {
@@ -1705,75 +1497,81 @@ void Executor::visit(ForStat &node) {
         throw RuntimeError("Line ...: internal error: iterable is null");
     }
 
-    // Вспомогательная лямбда для получения строкового представления типа объекта,
-    // чтобы корректно формировать сообщения об ошибках.
-    
+    // Связать имена-итераторы с очередным элементом. Если имён несколько
+    // (распаковка), элемент должен быть списком или кортежем той же длины.
+    auto bind_element = [&](const ObjectPtr &element) {
+        // 3.1) Если у нас единичный итератор, просто связываем его с element.
+        if (node.iterators.size() == 1) {
+            store_name(node.iteratorRefs[0], node.iterators[0], element, SymbolType::Variable, &node);
+            return;
+        }
+        // 3.2) Распаковка: пары enumerate приходят кортежами, но годится и список
+        size_t innerSize;
+        if (auto innerTuple = kind_cast<PyTuple>(element)) {
+            innerSize = innerTuple->size();
+        } else if (auto innerList = kind_cast<PyList>(element)) {
+            innerSize = innerList->size();
+        } else {
+            throw RuntimeError(
+                "Line " + std::to_string(node.line)
+                + " TypeError: cannot unpack non-iterable element '" 
+                + element->repr() + "'"
+            );
+        }
+        if (innerSize != node.iterators.size()) {
+            throw RuntimeError(
+                "Line " + std::to_string(node.line)
+                + " ValueError: not enough values to unpack (expected "
+                + std::to_string(node.iterators.size()) + ", got "
+                + std::to_string(innerSize) + ")"
+            );
+        }
+        // Присваиваем по позициям
+        auto innerTuple = kind_cast<PyTuple>(element);
+        for (size_t k = 0; k < node.iterators.size(); ++k) {
+            ObjectPtr value = innerTuple ? innerTuple->item(k) : static_cast<PyList&>(*element).item(k);
+            store_name(node.iteratorRefs[k], node.iterators[k], value, SymbolType::Variable, &node);
+        }
+    };
 
+    switch (iterableVal->kind()) {
     // 3) Реализуем поведение для списков (PyList).
-    if (auto listObj = std::dynamic_pointer_cast<PyList>(iterableVal)) {
-        const auto &elements = listObj->getElements();
+    case Kind::List: {
+        const PyList &list = static_cast<PyList&>(*iterableVal);
         // Проходим по каждому элементу списка
-        for (size_t idx = 0; idx < elements.size(); ++idx) {
-            ObjectPtr element = elements[idx];
+        for (size_t idx = 0; idx < list.size(); ++idx) {
+            bind_element(list.item(idx));
 
-            // 3.1) Если у нас единичный итератор, просто связываем его с element.
-            if (node.iterators.size() == 1) {
-                Symbol *sym = scopes.lookup_local(node.iterators[0]);
-                sym->value = element;
-            }
-            // 3.2) Если у нас несколько имён-итераторов (распаковка), ожидаем, что элемент тоже PyList
-            else {
-                auto innerList = std::dynamic_pointer_cast<PyList>(element);
-                if (!innerList) {
-                    throw RuntimeError(
-                        "Line " + std::to_string(node.line)
-                        + " TypeError: cannot unpack non-iterable element '" 
-                        + element->repr() + "'"
-                    );
-                }
-                const auto &innerElems = innerList->getElements();
-                if (innerElems.size() != node.iterators.size()) {
-                    throw RuntimeError(
-                        "Line " + std::to_string(node.line)
-                        + " ValueError: not enough values to unpack (expected "
-                        + std::to_string(node.iterators.size()) + ", got "
-                        + std::to_string(innerElems.size()) + ")"
-                    );
-                }
-                // Присваиваем по позициям
-                for (size_t k = 0; k < node.iterators.size(); ++k) {
-                    Symbol *sym = scopes.lookup_local(node.iterators[k]);
-                    sym->value = innerElems[k];
-                }
+            // 3.3) Выполняем тело цикла
+            if (node.body && !run_loop_body(*node.body)) {
+                break;
             }
+        }
+        return;
+    }
 
-            // 3.3) Выполняем тело цикла
-            if (node.body) {
-                try {
-                    node.body->accept(*this);
-                }
-                catch (const BreakException &) {
-                    break;
-                }
-                catch (const ContinueException &) {
-                    continue;
-                }
+    // 3a) Кортеж — так же, как список (он неизменяем, обход без снимка)
+    case Kind::Tuple: {
+        const PyTuple &tuple = static_cast<PyTuple&>(*iterableVal);
+        for (size_t idx = 0; idx < tuple.size(); ++idx) {
+            bind_element(tuple.item(idx));
+            if (node.body && !run_loop_body(*node.body)) {
+                break;
             }
         }
-    return;
-}
+        return;
+    }
 
     // 4) Реализуем поведение для строк (PyString) — итерируем по символам.
-    if (auto strObj = std::dynamic_pointer_cast<PyString>(iterableVal)) {
-        const std::string &s = strObj->get();
+    case Kind::String: {
+        const std::string &s = static_cast<PyString&>(*iterableVal).get();
         for (size_t i = 0; i < s.size(); ++i) {
-            // Каждый символ представляем как PyString длины 1
-            auto charObj = std::make_shared<PyString>(std::string(1, s[i]));
+            // Каждый символ — PyString длины 1 из таблицы py_char
+            ObjectPtr charObj = py_char(s[i]);
 
             // 4.1) Если один итератор, присваиваем символ
             if (node.iterators.size() == 1) {
-                Symbol *sym = scopes.lookup_local(node.iterators[0]);
-                sym->value = charObj;
+                store_name(node.iteratorRefs[0], node.iterators[0], charObj, SymbolType::Variable, &node);
             }
             // 4.2) Если множественная распаковка — это не поддерживается для строк в Python стандартно,
             //       поэтому бросаем ошибку распаковки.
@@ -1786,21 +1584,17 @@ void Executor::visit(ForStat &node) {
             }
 
             // 4.3) Выполняем тело цикла
-            if (node.body) {
-                try {
-                    node.body->accept(*this);
-                }
-                catch (const BreakException &) {
-                    break;
-                }
-                catch (const ContinueException &) {
-                    continue;
-                }
+            if (node.body && !run_loop_body(*node.body)) {
+                break;
             }
         }
         return;
     }
 
+    default:
+        break;
+    }
+
     // 5) Для любых других типов (dict, set, пользовательские объекты и т.д.) — 
     //    бросаем TypeError: '<type>' object is not iterable.
     std::string badType = deduceTypeName(iterableVal);
@@ -1810,21 +1604,61 @@ void Executor::visit(ForStat &node) {
     );
 }
 
+bool Executor::run_loop_body(BlockStat &body) {
+    // Выполняем одну итерацию тела и «поглощаем» break/continue этого цикла.
+    // Возвращаем false, если цикл надо прекратить (break или return изнутри).
+    // Начало итерации — безопасная точка для сборки циклов.
+    GcHeap::collect_if_due();
+    ++loop_depth;
+    try {
+        body.accept(*this);
+    }
+    catch (...) {
+        --loop_depth;
+        throw;
+    }
+    --loop_depth;
+
+    switch (completion.flow) {
+        case Flow::Break:
+            completion = Completion{};
+            return false;
+        case Flow::Continue:
+            completion = Completion{};
+            return true;
+        case Flow::Return:
+            // return летит дальше — до вызова функции
+            return false;
+        case Flow::Normal:
+        default:
+            return true;
+    }
+}
+
 void Executor::visit(BreakStat &node) {
     // В Python break может быть только внутри цикла.
-    // Здесь мы просто выбрасываем BreakException, которую
-    // должны поймать вокруг тела цикла (в visit(ForStat) или visit(WhileStat)).
-    //
-    // Если break встретится вне цикла, это исключение поднимется
-    // до самого execute(), и превратится в необработанную ошибку времени выполнения,
-    // что соответствует поведению «break outside loop».
-    throw BreakException{};
+    // Мы не прыгаем сразу, а оставляем запись Flow::Break: BlockStat
+    // перестанет выполнять оставшиеся инструкции, а ближайший цикл
+    // (см. run_loop_body) её поглотит и завершится.
+    if (loop_depth == 0) {
+        throw RuntimeError(
+            "Line " + std::to_string(node.line)
+            + " SyntaxError: 'break' outside loop"
+        );
+    }
+    completion.flow = Flow::Break;
 }
 
 void Executor::visit(ContinueStat &node) {
-    // Аналогично break, continue выбрасывает своё исключение.
-    // Цикл (ForStat или WhileStat) должен его поймать и перейти к следующей итерации.
-    throw ContinueException{};
+    // Аналогично break: оставляем Flow::Continue, цикл пропустит
+    // остаток тела и перейдёт к следующей итерации.
+    if (loop_depth == 0) {
+        throw RuntimeError(
+            "Line " + std::to_string(node.line)
+            + " SyntaxError: 'continue' not properly in loop"
+        );
+    }
+    completion.flow = Flow::Continue;
 }
 
 void Executor::visit(PassStat &node) {
@@ -1846,7 +1680,7 @@ void Executor::visit(AssertStat &node) {
         );
     }
     node.condition->accept(*this);
-    ObjectPtr condObj = pop_value();
+    Value condObj = pop();
 
     // 2) Определяем truthiness так же, как в других местах:
 
@@ -1858,61 +1692,23 @@ void Executor::visit(AssertStat &node) {
 
     // 3) Если условие ложно — нужно бросить AssertionError.
     // Если был передан второй аргумент (сообщение), вычисляем его:
-    std::string message;
+    ObjectPtr msgObj;
     if (node.message) {
-        // node.expr — это сообщение, которое передается после запятой
         node.message->accept(*this);
-        ObjectPtr msgObj = pop_value();
-        // Делаем repr() и используем это в сообщении
-        message = msgObj->repr();
-    }
-
-    // 4) Формируем текст ошибки. В Python бывает просто "AssertionError",
-    // или "AssertionError: <message>".
-    std::string errorText = "AssertionError";
-    if (!message.empty()) {
-        errorText += ": ";
-        errorText += message;
+        msgObj = pop_value();
     }
-
-    // 5) Бросаем RuntimeError с текстом AssertionError
-    throw RuntimeError(
-        "Line " + std::to_string(node.line) + " " + errorText
-    );
+    raise_assertion(msgObj, node.line);
 }
 
 void Executor::visit(ExitStat &node) {
     // В Python вызов quit()/exit() (или sys.exit()) вызывает SystemExit.
-    // Мы эмулируем поведение: если аргумент — целое число, используем его как код возврата;
-    // если это любой другой объект, печатаем его и возвращаем код 1.
-    //
-    // 1) Если есть выражение, вычисляем его; иначе считаем, что exit() без аргументов → код 0.
-    int exitCode = 0;
+    // Если есть выражение, вычисляем его; иначе считаем, что exit() без аргументов → код 0.
+    ObjectPtr val;
     if (node.expr) {
         node.expr->accept(*this);
-        ObjectPtr val = pop_value();
-
-        // Если это PyInt или PyBool или PyFloat, пытаемся получить целое:
-        if (auto i = std::dynamic_pointer_cast<PyInt>(val)) {
-            exitCode = i->get();
-        }
-        else if (auto b = std::dynamic_pointer_cast<PyBool>(val)) {
-            // True → 1, False → 0
-            exitCode = b->get() ? 1 : 0;
-        }
-        else if (auto f = std::dynamic_pointer_cast<PyFloat>(val)) {
-            // Приводим к int (отбрасываем дробную часть)
-            exitCode = static_cast<int>(f->get());
-        }
-        else {
-            // Любой другой объект: печатаем его repr() как текст на stderr и выходим с кодом 1
-            std::cerr << val->repr() << std::endl;
-            std::exit(1);
-        }
+        val = pop_value();
     }
-
-    // 2) Теперь действительно выходим с собранным кодом
-    std::exit(exitCode);
+    exit_program(val);
 }
 
 void Executor::visit(PrintStat &node) {
@@ -1938,67 +1734,62 @@ void Executor::visit(DirStat &node) {}
 void Executor::visit(EnumerateStat &node) {}
 
 
-void Executor::visit(ClassDecl &node) {
+Ref<PyClass> Executor::make_class(ClassDecl &node) {
 
-    std::shared_ptr<PyClass> parentClass = nullptr;
+    std::vector<Ref<PyClass>> baseClasses;
 
-    // Если в AST указано хоть одно имя базового класса:
-    if (!node.baseClasses.empty()) {
-        // 1.1) Если указано более одного — мы не поддерживаем множественное наследование
-        if (node.baseClasses.size() > 1) {
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + ": multiple inheritance is not supported"
-            );
-        }
+    // Базовые классы (их может быть несколько — порядок поиска атрибутов
+    // строит PyClass по C3, см. PyClass::mro)
+    for (size_t i = 0; i < node.baseClasses.size(); ++i) {
+        const std::string &baseName = node.baseClasses[i];
 
-        // 1.2) Берём единственное имя базового класса
-        const std::string &baseName = node.baseClasses[0];
+        // 1.1) Ищем имя там, куда указал резолвер (если имени нет — load_name бросит NameError)
+        ObjectPtr baseObj = load_name(node.baseRefs[i], baseName, node.line).object();
 
-        // 1.3) Ищем его в текущих областях видимости
-        Symbol *baseSym = scopes.lookup(baseName);
-        if (!baseSym) {
-            // Класс-наследник ссылается на несуществующее имя
-            throw RuntimeError(
-                "Line " + std::to_string(node.line)
-                + ": name '" + baseName + "' is not defined"
-            );
-        }
-
-        // 1.4) Проверяем, что найденный символ действительно представляет собой класс
-        //      То есть baseSym->value должно быть PyClass
-        ObjectPtr baseObj = baseSym->value;
-        parentClass = std::dynamic_pointer_cast<PyClass>(baseObj);
-        if (!parentClass) {
+        // 1.2) Проверяем, что найденный объект действительно представляет собой класс
+        auto *baseClass = kind_cast<PyClass>(baseObj);
+        if (!baseClass) {
             // Если это не PyClass, бросаем TypeError
             throw RuntimeError(
                 "Line " + std::to_string(node.line)
                 + ": TypeError: '" + baseName + "' is not a class"
             );
         }
+        for (const auto &seen : baseClasses) {
+            if (seen.get() == baseClass) {
+                throw RuntimeError(
+                    "Line " + std::to_string(node.line)
+                    + ": TypeError: duplicate base class " + baseName
+                );
+            }
+        }
+        baseClasses.emplace_back(baseClass);
     }
 
     // 1) Сначала создаём «объект класса» PyClass, у которого будет своё собственное пространство имён.
-    //    Передаём ему строку с именем класса node.name.
-    auto classObj = std::make_shared<PyClass>(node.name, parentClass);
+    //    Противоречивый порядок баз (нет C3-линеаризации) — TypeError.
+    Ref<PyClass> classObj;
+    try {
+        classObj = make_ref<PyClass>(node.name, std::move(baseClasses));
+    }
+    catch (const RuntimeError &err) {
+        throw RuntimeError("Line " + std::to_string(node.line) + ": " + err.what());
+    }
 
-    // 2) Регистрируем сам класс в текущей (лексической) таблице символов,
-    //    чтобы сразу после объявления можно было писать:
+    // 2) Регистрируем сам класс под его именем (в таблице символов модуля
+    //    или в локальном слоте объемлющей функции), чтобы сразу после объявления можно было писать:
     //        class X: ...
     //        x = X()
-    //    и имя X было доступно. 
-    Symbol classSymbol;
-    classSymbol.name  = node.name;
-    classSymbol.type  = SymbolType::UserClass;
-    classSymbol.value = classObj;
-    classSymbol.decl  = &node;
-
-    // Если в локальном скоупе уже есть символ с таким именем – перезапишем, иначе – просто вставим.
-    if (auto existing = scopes.lookup_local(node.name)) {
-        *existing = classSymbol;
-    } else {
-        scopes.insert(classSymbol);
-    }
+    //    и имя X было доступно. Если имя уже было – перезапишем.
+    store_name(node.nameRef, node.name, classObj, SymbolType::UserClass, &node);
+
+    return classObj;
+}
+
+void Executor::visit(ClassDecl &node) {
+    // 1–2) Создаём объект класса (с базовым классом, если он указан)
+    //      и регистрируем его под именем класса — см. make_class.
+    auto classObj = make_class(node);
 
     // 3) Обрабатываем все «поля» (FieldDecl) внутри тела класса. 
     //    Для каждого FieldDecl: 
@@ -2010,7 +1801,7 @@ void Executor::visit(ClassDecl &node) {
         const std::string &fieldName = fieldPtr->name; 
         ObjectPtr initValue;
 
-        if (!initValue) initValue = std::make_shared<PyNone>();
+        if (!initValue) initValue = py_none();
 
         // 3.1) Если у поля есть initExpr, то вычисляем его и «снимаем» результат со стека.
         if (fieldPtr->initExpr) {
@@ -2018,12 +1809,12 @@ void Executor::visit(ClassDecl &node) {
             initValue = pop_value();
         } else {
             // Если инициализатора нет вовсе – кладём PyNone
-            initValue = std::make_shared<PyNone>();
+            initValue = py_none();
         }
 
         // 3.2) Собираем ключ (PyString с именем поля) и кладём пару (ключ, значение) в classDict
-        auto key = std::make_shared<PyString>(fieldName);
-        classObj->classDict->__setitem__(key, initValue);
+        auto key = py_intern(fieldName);
+        classObj->__setattr__(key, initValue);
     }
 
     // 4) Обрабатываем все «методы» (FuncDecl) внутри тела класса. 
@@ -2059,37 +1850,34 @@ void Executor::visit(ClassDecl &node) {
                 default_values.push_back(val);
             } else {
                 // Если вдруг в defaultParams попал nullptr (маловероятно), ставим None
-                default_values.push_back(std::make_shared<PyNone>());
+                default_values.push_back(py_none());
             }
         }
 
         // ------------------------
-        // 4.2) Сконструируем объект PyFunction.
-        //       Ему нужно передать:
-        //         - имя функции: fdecl->name
-        //         - указатель на AST-узел FuncDecl: fdecl
-        //         - лексическое окружение (таблица символов) – прямо currentTable()
-        //         - список positional параметров – fdecl->posParams
-        //         - вектор заранее вычисленных default‐значений – default_values
+        // 4.2) Сконструируем объект PyFunction (как для обычного def):
+        //       FuncDecl, default-значения и ячейки замыкания, если класс объявлен внутри функции.
         // ------------------------
-        auto fnObj = std::make_shared<PyFunction>(
-            fdecl->name,               // const std::string &funcName
-            fdecl,                     // FuncDecl *f
-            scopes.currentTable(),     // std::shared_ptr<SymbolTable> enclosingEnv
-            fdecl->posParams,          // const std::vector<std::string> &parameters
-            std::move(default_values)  // std::vector<ObjectPtr> defaults
-        );
+        auto fnObj = make_function(*fdecl, std::move(default_values));
 
         // ------------------------
         // 4.3) Кладём fnObj в словарь класса classDict под ключом methodName.
         //       После этого, при запросе myInstance.methodName, в __getattr__ сначала найдётся
         //       метод в classDict, и дальше его можно будет вызывать как обычную функцию.
         // ------------------------
-        auto key = std::make_shared<PyString>(fdecl->name);
-        classObj->classDict->__setitem__(key, fnObj);
+        auto key = py_intern(fdecl->name);
+        classObj->__setattr__(key, fnObj);
     }
 
-    // 5) В конце кладём сам объект класса (classObj) на «стек значений».
+    // 5) Тело исполнено — по __slots__ фиксируем раскладку экземпляров
+    try {
+        classObj->seal_layout();
+    }
+    catch (const RuntimeError &err) {
+        throw RuntimeError("Line " + std::to_string(node.line) + ": " + err.what());
+    }
+
+    // 6) В конце кладём сам объект класса (classObj) на «стек значений».
     //    Это нужно, чтобы если кто-то написал что-то вроде:
     //         C = class Foo: ... 
     //     и с точки зрения AST это выражение возвращает сам объект класса,
@@ -2111,15 +1899,25 @@ void Executor::visit(ListComp &node) {
 
     // Шаг 2: выделяем вектор «сырых» элементов, по которым будем итерироваться.
     // Поддерживаем PyList и PyString. Всё остальное — не итерируемый.
-    std::vector<ObjectPtr> rawElems;
-    if (auto listObj = std::dynamic_pointer_cast<PyList>(iterableVal)) {
-        rawElems = listObj->getElements();
+    // Список обходим по снимку его буфера (без копирования элементов),
+    // строку — по символам
+    Ref<ListBuffer> snapshot;
+    if (auto listObj = kind_cast<PyList>(iterableVal)) {
+        snapshot = listObj->buffer();
+    }
+    else if (auto tupleObj = kind_cast<PyTuple>(iterableVal)) {
+        snapshot = make_ref<ListBuffer>();
+        snapshot->reserve(tupleObj->size());
+        for (size_t i = 0; i < tupleObj->size(); ++i) {
+            snapshot->push_back(tupleObj->item(i));
+        }
     }
-    else if (auto strObj = std::dynamic_pointer_cast<PyString>(iterableVal)) {
+    else if (auto strObj = kind_cast<PyString>(iterableVal)) {
         const std::string &s = strObj->get();
-        rawElems.reserve(s.size());
+        snapshot = make_ref<ListBuffer>();
+        snapshot->reserve(s.size());
         for (char c : s) {
-            rawElems.push_back(std::make_shared<PyString>(std::string(1, c)));
+            snapshot->push_back(py_char(c));
         }
     }
     else {
@@ -2134,25 +1932,16 @@ void Executor::visit(ListComp &node) {
     // Шаг 3: для каждого элемента «итерируемого»:
     //  a) создаём символ в локальном scope с именем node.iterVar → присваиваем текущий элемент
     //  b) вычисляем valueExpr (там может быть обращение к iterVar)
-    //  c) сохраняем результат в вектор resultElems
-    std::vector<ObjectPtr> resultElems;
-    resultElems.reserve(rawElems.size());
+    //  c) сохраняем результат в буфер resultElems
+    const ListBuffer &rawElems = *snapshot;
+    auto resultElems = make_ref<ListBuffer>();
+    resultElems->reserve(rawElems.size());
 
     for (size_t i = 0; i < rawElems.size(); ++i) {
-        ObjectPtr element = rawElems[i];
+        ObjectPtr element = rawElems.get(i);
 
-        // 3.a) Если имя iterVar ещё не было объявлено в локальном scope, мы вставляем его:
-        if (!scopes.lookup_local(node.iterVar)) {
-            Symbol sym;
-            sym.name  = node.iterVar;
-            sym.type  = SymbolType::Variable;
-            sym.value = nullptr;
-            sym.decl  = nullptr; // было бы nice указывать на node, но не критично
-            scopes.insert(sym);
-        }
-        // Кладём в локальный scope текущее значение element:
-        Symbol *iterSym = scopes.lookup_local(node.iterVar);
-        iterSym->value = element;
+        // 3.a) Присваиваем iterVar текущее значение element (куда — решил резолвер):
+        store_name(node.iterRef, node.iterVar, element);
 
         // 3.b) Теперь вычисляем valueExpr:
         node.valueExpr->accept(*this);
@@ -2163,11 +1952,11 @@ void Executor::visit(ListComp &node) {
                 + ": internal error: list comprehension element evaluated to null"
             );
         }
-        resultElems.push_back(val);
+        resultElems->push_back(val);
     }
 
     // Шаг 4: после всех итераций собираем PyList из resultElems
-    auto listObj = std::make_shared<PyList>(std::move(resultElems));
+    auto listObj = make_ref<PyList>(std::move(resultElems));
     push_value(listObj);
 }
 
@@ -2184,15 +1973,25 @@ void Executor::visit(DictComp &node) {
     }
 
     // Шаг 2: собираем сырой вектор элементов
-    std::vector<ObjectPtr> rawElems;
-    if (auto listObj = std::dynamic_pointer_cast<PyList>(iterableVal)) {
-        rawElems = listObj->getElements();
+    // Список обходим по снимку его буфера (без копирования элементов),
+    // строку — по символам
+    Ref<ListBuffer> snapshot;
+    if (auto listObj = kind_cast<PyList>(iterableVal)) {
+        snapshot = listObj->buffer();
+    }
+    else if (auto tupleObj = kind_cast<PyTuple>(iterableVal)) {
+        snapshot = make_ref<ListBuffer>();
+        snapshot->reserve(tupleObj->size());
+        for (size_t i = 0; i < tupleObj->size(); ++i) {
+            snapshot->push_back(tupleObj->item(i));
+        }
     }
-    else if (auto strObj = std::dynamic_pointer_cast<PyString>(iterableVal)) {
+    else if (auto strObj = kind_cast<PyString>(iterableVal)) {
         const std::string &s = strObj->get();
-        rawElems.reserve(s.size());
+        snapshot = make_ref<ListBuffer>();
+        snapshot->reserve(s.size());
         for (char c : s) {
-            rawElems.push_back(std::make_shared<PyString>(std::string(1, c)));
+            snapshot->push_back(py_char(c));
         }
     }
     else {
@@ -2204,22 +2003,14 @@ void Executor::visit(DictComp &node) {
     }
 
     // Шаг 3: создаём новый пустой словарь, потом наполняем его
-    auto dictObj = std::make_shared<PyDict>();
+    auto dictObj = make_ref<PyDict>();
 
+    const ListBuffer &rawElems = *snapshot;
     for (size_t i = 0; i < rawElems.size(); ++i) {
-        ObjectPtr element = rawElems[i];
+        ObjectPtr element = rawElems.get(i);
 
-        // 3.a) «вставляем» в локальный scope iterVar = element
-        if (!scopes.lookup_local(node.iterVar)) {
-            Symbol sym;
-            sym.name  = node.iterVar;
-            sym.type  = SymbolType::Variable;
-            sym.value = nullptr;
-            sym.decl  = nullptr;
-            scopes.insert(sym);
-        }
-        Symbol *iterSym = scopes.lookup_local(node.iterVar);
-        iterSym->value = element;
+        // 3.a) присваиваем iterVar = element
+        store_name(node.iterRef, node.iterVar, element);
 
         // 3.b) вычисляем keyExpr
         node.keyExpr->accept(*this);
@@ -2267,15 +2058,25 @@ void Executor::visit(TupleComp &node) {
         );
     }
 
-    std::vector<ObjectPtr> rawElems;
-    if (auto listObj = std::dynamic_pointer_cast<PyList>(iterableVal)) {
-        rawElems = listObj->getElements();
+    // Список обходим по снимку его буфера (без копирования элементов),
+    // строку — по символам
+    Ref<ListBuffer> snapshot;
+    if (auto listObj = kind_cast<PyList>(iterableVal)) {
+        snapshot = listObj->buffer();
+    }
+    else if (auto tupleObj = kind_cast<PyTuple>(iterableVal)) {
+        snapshot = make_ref<ListBuffer>();
+        snapshot->reserve(tupleObj->size());
+        for (size_t i = 0; i < tupleObj->size(); ++i) {
+            snapshot->push_back(tupleObj->item(i));
+        }
     }
-    else if (auto strObj = std::dynamic_pointer_cast<PyString>(iterableVal)) {
+    else if (auto strObj = kind_cast<PyString>(iterableVal)) {
         const std::string &s = strObj->get();
-        rawElems.reserve(s.size());
+        snapshot = make_ref<ListBuffer>();
+        snapshot->reserve(s.size());
         for (char c : s) {
-            rawElems.push_back(std::make_shared<PyString>(std::string(1, c)));
+            snapshot->push_back(py_char(c));
         }
     }
     else {
@@ -2286,21 +2087,13 @@ void Executor::visit(TupleComp &node) {
         );
     }
 
-    std::vector<ObjectPtr> resultElems;
-    resultElems.reserve(rawElems.size());
+    const ListBuffer &rawElems = *snapshot;
+    auto resultElems = make_ref<ListBuffer>();
+    resultElems->reserve(rawElems.size());
 
     for (size_t i = 0; i < rawElems.size(); ++i) {
-        ObjectPtr element = rawElems[i];
-        if (!scopes.lookup_local(node.iterVar)) {
-            Symbol sym;
-            sym.name  = node.iterVar;
-            sym.type  = SymbolType::Variable;
-            sym.value = nullptr;
-            sym.decl  = nullptr;
-            scopes.insert(sym);
-        }
-        Symbol *iterSym = scopes.lookup_local(node.iterVar);
-        iterSym->value = element;
+        ObjectPtr element = rawElems.get(i);
+        store_name(node.iterRef, node.iterVar, element);
 
         node.valueExpr->accept(*this);
         ObjectPtr val = pop_value();
@@ -2310,12 +2103,11 @@ void Executor::visit(TupleComp &node) {
                 + ": internal error: tuple comprehension element evaluated to null"
             );
         }
-        resultElems.push_back(val);
+        resultElems->push_back(val);
     }
 
-    // вместо PyTuple просто «отдаём» PyList
-    auto listObj = std::make_shared<PyList>(std::move(resultElems));
-    push_value(listObj);
+    // Элементы собраны — кортеж получает их одним выделением памяти
+    push_value(PyTuple::from(*resultElems));
 }
 
 
@@ -2325,44 +2117,21 @@ void Executor::visit(TupleComp &node) {
 // объект типа PyFunction, который при вызове посчитает <expr>.
 // ------------------------------------
 void Executor::visit(LambdaExpr &node) {
-    // 1) Сразу «вырвем» из LambdaExpr само выражение тела (move),
-    //    чтобы не вычислять его на этом этапе, а передать в новый FuncDecl.
-    //    После этого node.body станет nullptr (мы больше к нему не обратимся —
-    //    лямбда создаётся только один раз).
-    std::unique_ptr<Expression> bodyExpr = std::move(node.body);
-
-    // 2) Оборачиваем тело лямбды в одну-единственную инструкцию ReturnStat,
-    //    иначе PyFunction не «увидит» какое значение возвращать.
-    //    ReturnStat сам бросит ReturnException, когда встретится во время исполнения.
-    auto returnStmt = std::make_unique<ReturnStat>(std::move(bodyExpr), node.line);
-
-    // 3) Создадим «временный» FuncDecl. Назовём его "<lambda>", 
-    //    перенесём туда список параметров (node.params) и наш returnStmt.
-    //    (По факту мы роняем все default-параметры, они у лямбды не поддерживаются.)
-    FuncDecl *lambdaDecl = new FuncDecl(
-        "<lambda>",                     // имя функции (строго говоря, оно не используется)
-        node.params,                    // параметры (имена)
-        std::vector<std::pair<std::string, std::unique_ptr<Expression>>>{}, // default-параметры пустые
-        std::move(returnStmt),          // тело — это единственный ReturnStat
-        node.line                       // строка, где встретилась лямбда
-    );
+    // 1) Тело лямбды резолвер заранее обернул в ReturnStat внутри node.decl
+    //    (FuncDecl с именем "<lambda>" и параметрами node.params), так что
+    //    одна и та же лямбда может вычисляться сколько угодно раз.
+    if (!node.decl) {
+        throw RuntimeError(
+            "Line " + std::to_string(node.line)
+            + ": internal error: lambda was not resolved"
+        );
+    }
 
-    // 4) Создаём объект PyFunction, передавая ему:
-    //    - имя "<lambda>"
-    //    - указатель на lambdaDecl (AST-узел)
-    //    - текущее лексическое окружение (то, что лежит в scopes.currentTable())
-    //    - вектор имён позиционных параметров
-    //    - пустой вектор default-значений (их у нас нет)
-    auto lambdaObj = std::make_shared<PyFunction>(
-        "<lambda>",
-        lambdaDecl,
-        scopes.currentTable(),
-        node.params,
-        std::vector<ObjectPtr>{}     // default-значения (пустой список)
-    );
+    // 2) Создаём объект PyFunction (default-значений у лямбды нет),
+    //    захватывая ячейки свободных переменных из текущего кадра.
+    auto lambdaObj = make_function(*node.decl, std::vector<ObjectPtr>{});
 
-    // 5) Кладём получившийся объект PyFunction на стек значений.
-    //    Когда кто-нибудь вызовет этот объект, в нём запустится
-    //    лексическое окружение, и выполнятся наши ReturnStat-ы.
+    // 3) Кладём получившийся объект PyFunction на стек значений.
+    //    Когда кто-нибудь вызовет этот объект, выполнится наш ReturnStat.
     push_value(lambdaObj);
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "object.hpp"
+
+#include <chrono>
+
+// Сборка циклов пробным удалением (см. GcObject в object.hpp).
+//
+// gcRefs каждого контейнера проходит три состояния:
+//   1) копия счётчика ссылок;
+//   2) минус ссылки из других контейнеров — остаток = ссылки извне;
+//   3) REACHABLE, если объект достижим из контейнера с внешними ссылками.
+// Кто остался с нулём — недостижим. Молодая сборка делает то же самое
+// только для objects[oldCount, size).
+
+namespace {
+
+constexpr uint32_t REACHABLE = UINT32_MAX;
+
+// Граница поколения и очередь обхода для колбэков gc_traverse
+struct Scope {
+    std::size_t first;
+    std::vector<GcObject*> *pending;
+};
+
+} // namespace
+
+// Участвует ли child в сборке: записан в GcHeap и не старше first
+bool GcHeap::in_scope(const Object *child, std::size_t first) {
+    return child->gc_tracked() && static_cast<const GcObject*>(child)->gcIndex >= first;
+}
+
+void GcHeap::collect(std::size_t first) {
+    if (collecting) {
+        return;
+    }
+    collecting = true;
+    auto start = std::chrono::steady_clock::now();
+    const std::size_t end = objects.size();
+
+    // 1) Начальные значения — полные счётчики ссылок
+    for (std::size_t i = first; i < end; ++i) {
+        objects[i]->gcRefs = objects[i]->refcount();
+    }
+
+    // 2) Вычитаем ссылки между контейнерами поколения. Ссылки из старшего
+    //    поколения не вычитаются — для молодой сборки они внешние.
+    std::vector<GcObject*> pending;
+    Scope scope{first, &pending};
+    for (std::size_t i = first; i < end; ++i) {
+        objects[i]->gc_traverse([](Object *child, void *ctx) {
+            if (in_scope(child, static_cast<Scope*>(ctx)->first)) {
+                --static_cast<GcObject*>(child)->gcRefs;
+            }
+        }, &scope);
+    }
+
+    // 3) Всё, на что ссылаются извне, и всё достижимое из него — живое
+    for (std::size_t i = first; i < end; ++i) {
+        GcObject *obj = objects[i];
+        if (obj->gcRefs > 0 && obj->gcRefs != REACHABLE) {
+            obj->gcRefs = REACHABLE;
+            pending.push_back(obj);
+        }
+    }
+    while (!pending.empty()) {
+        GcObject *obj = pending.back();
+        pending.pop_back();
+        obj->gc_traverse([](Object *child, void *ctx) {
+            auto *sc = static_cast<Scope*>(ctx);
+            if (!in_scope(child, sc->first)) {
+                return;
+            }
+            auto *gc = static_cast<GcObject*>(child);
+            if (gc->gcRefs != REACHABLE) {
+                gc->gcRefs = REACHABLE;
+                sc->pending->push_back(gc);
+            }
+        }, &scope);
+    }
+
+    // 4) Мусор держим через Ref, пока рвём его ссылки: иначе объект мог бы
+    //    освободиться посреди gc_clear соседа. Отпускаем все разом в конце.
+    std::vector<ObjectPtr> garbage;
+    for (std::size_t i = first; i < end; ++i) {
+        if (objects[i]->gcRefs == 0) {
+            garbage.emplace_back(objects[i]);
+        }
+    }
+    for (auto &obj : garbage) {
+        static_cast<GcObject&>(*obj).gc_clear();
+    }
+    std::size_t freed = garbage.size();
+    garbage.clear();
+
+    // 5) Выжившие молодые переходят в старое поколение
+    std::size_t promoted = objects.size() - oldCount;
+    oldCount = objects.size();
+    if (first == 0) {
+        ++totals.fullCollections;
+        oldAfterFull = oldCount;
+        promotedSinceFull = 0;
+    } else {
+        ++totals.youngCollections;
+        promotedSinceFull += promoted;
+    }
+
+    std::chrono::duration<double, std::milli> pause = std::chrono::steady_clock::now() - start;
+    totals.freed += freed;
+    totals.promoted += promoted;
+    totals.pauseMs += pause.count();
+    totals.maxPauseMs = std::max(totals.maxPauseMs, pause.count());
+    collecting = false;
+}
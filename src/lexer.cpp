@@ -64,6 +64,7 @@ const std::unordered_map<std::string, TokenType> operator_map = {
     {"**=", TokenType::POWEQUAL},
 
     // Битовые операторы
+    {"|", TokenType::VBAR}, {"&", TokenType::AMPER}, {"^", TokenType::CIRCUMFLEX},
     {"&=", TokenType::AND}, {"|=", TokenType::OR}, {"^=", TokenType::NOT},
     {">>", TokenType::IS}, {"<<", TokenType::ISNOT}, {">>=", TokenType::IS}, {"<<=", TokenType::ISNOT},
 
@@ -6,10 +6,42 @@
 #include <cstdio>
 #include "parser.hpp"
 #include "executer.hpp"
+#include <chrono>
+#include <string>
 
-int main() {
+// Использование: test_lexer [-q] [-t] [--stats] [--stackless] [--recursion-limit N] [--tail-calls] [file.py]
+//   -q  — не печатать токены и AST (только вывод самой программы)
+//   -t  — после выполнения напечатать время исполнения (для бенчмарков из bench/)
+//   --stats — после выполнения напечатать, сколько объектов было создано, и статистику сборки циклов
+//   --stackless — исполнять байткод: кадры вызовов в куче, без рекурсии C++
+//   --recursion-limit N — максимальная глубина вызовов (по умолчанию 1000)
+//   --tail-calls — return f(...) переиспользует кадр вызывающего (глубина не растёт)
+int main(int argc, char **argv) {
     
     std::string file_name = "build/bin/test.py";
+    bool quiet = false;
+    bool timing = false;
+    bool stats = false;
+    ExecutorOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-q") {
+            quiet = true;
+        } else if (arg == "-t") {
+            timing = true;
+        } else if (arg == "--stats") {
+            stats = true;
+        } else if (arg == "--stackless") {
+            options.stackless = true;
+        } else if (arg == "--tail-calls") {
+            options.tailCalls = true;
+        } else if (arg == "--recursion-limit" && i + 1 < argc) {
+            options.recursionLimit = std::stoi(argv[++i]);
+        } else {
+            file_name = arg;
+        }
+    }
+
     std::ifstream file(file_name);
     if (!file) {
         std::cerr << "Cannot open file: " << file_name << std::endl;
@@ -17,9 +49,9 @@ int main() {
     }
     std::string line;
     std::string code;
-    std::cout<<"READ FROM FILE \n";
+    if (!quiet) std::cout<<"READ FROM FILE \n";
     while(std::getline(file, line)) {
-        std::cout<<"line \n";
+        if (!quiet) std::cout<<"line \n";
         code += line;
         code += '\n';
     }
@@ -30,17 +62,19 @@ int main() {
 
     Lexer lexer(code);
     std::vector<Token> tokens = lexer.tokenize();
-    std::cout<<"TEST \n";
+    if (!quiet) std::cout<<"TEST \n";
     // Вывод токенов
-    for (const auto& token : tokens) {
-        std::cout << "Token("
-                  << static_cast<int>(token.type) << ", "  
-                  << "\"" << token.value << "\", "
-                  << "line=" << token.line << ", "
-                  << "column=" << token.column << ")\n";
+    if (!quiet) {
+        for (const auto& token : tokens) {
+            std::cout << "Token("
+                      << static_cast<int>(token.type) << ", "  
+                      << "\"" << token.value << "\", "
+                      << "line=" << token.line << ", "
+                      << "column=" << token.column << ")\n";
+        }
     }
 
-    std::cout << "\n=== Parsing ===" << std::endl;
+    if (!quiet) std::cout << "\n=== Parsing ===" << std::endl;
     
     
     Parser parser(tokens);
@@ -48,16 +82,41 @@ int main() {
     
     auto ast = parser.parse();
 
-    ASTPrinterVisitor printer;
-    ast->accept(printer);
-    
-    std::cout << printer.getResult() << std::endl;
-    
-    std::cout << "AST successfully generated.\n" << std::endl;
+    if (!quiet) {
+        ASTPrinterVisitor printer;
+        ast->accept(printer);
+        
+        std::cout << printer.getResult() << std::endl;
+        
+        std::cout << "AST successfully generated.\n" << std::endl;
 
-    std::cout << "=== Execution ===\n";
-    Executor exec;
+        std::cout << "=== Execution ===\n";
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Executor exec(options);
     exec.execute(*ast);
+    auto finish = std::chrono::steady_clock::now();
+
+    if (timing) {
+        std::chrono::duration<double, std::milli> elapsed = finish - start;
+        std::cerr << "[" << file_name << "] " << elapsed.count() << " ms\n";
+    }
+    if (stats) {
+        std::cerr << "[" << file_name << "] objects allocated: " << Object::allocated << "\n";
+        const auto &gc = GcHeap::stats();
+        std::cerr << "[" << file_name << "] gc: " << gc.youngCollections << " young + "
+                  << gc.fullCollections << " full collections, " << gc.freed << " objects freed, "
+                  << gc.promoted << " promoted, " << GcHeap::tracked() << " tracked, pause "
+                  << gc.pauseMs << " ms total, " << gc.maxPauseMs << " ms max\n";
+        const auto &pool = Pool::stats();
+        double reuse = pool.allocations ? 100.0 * pool.reused / pool.allocations : 0;
+        double waste = pool.slabBytes ? 100.0 * (pool.slabBytes - pool.liveBytes) / pool.slabBytes : 0;
+        std::cerr << "[" << file_name << "] pool: " << pool.allocations << " allocations, "
+                  << reuse << "% from free lists, " << pool.large << " large, "
+                  << pool.slabBytes / 1024 << " KB in slabs, " << pool.liveBytes / 1024
+                  << " KB live, " << waste << "% free or uncarved\n";
+    }
     
     return 0;
 }
@@ -0,0 +1,713 @@
+#include "operations.hpp"
+
+#include <iostream>
+#include <iterator>
+#include <cstdlib>
+
+
+bool is_truthy(const ObjectPtr &obj) {
+        // Вид объекта — один байт, поэтому проверка за O(1) для всех встроенных
+        // типов (включая dict и set — по числу элементов, без repr()).
+        switch (obj->kind()) {
+            case Kind::Bool:   return static_cast<PyBool&>(*obj).get();
+            // Длинное целое (не short) нулём не бывает
+            case Kind::Int:    return !static_cast<PyInt&>(*obj).is_small() || static_cast<PyInt&>(*obj).get() != 0;
+            case Kind::Float:  return static_cast<PyFloat&>(*obj).get() != 0.0;
+            // Строки и контейнеры ложны, если они пустые (длина верёвки — без склейки)
+            case Kind::String: return static_cast<PyString&>(*obj).size() != 0;
+            case Kind::List:   return !static_cast<PyList&>(*obj).empty();
+            case Kind::Tuple:  return !static_cast<PyTuple&>(*obj).empty();
+            case Kind::Dict:   return !static_cast<PyDict&>(*obj).getItems().empty();
+            case Kind::Set:    return !static_cast<PySet&>(*obj).getElements().empty();
+            // None всегда ложь
+            case Kind::None:   return false;
+            // Любые другие объекты (функции, пользовательские объекты и т.д.) считаются истинными
+            default:           return true;
+        }
+}
+
+std::string deduceTypeName(const ObjectPtr &obj) {
+        return kind_name(obj->kind());
+}
+
+ObjectPtr literal_value(const LiteralExpr &node) {
+    // В LiteralExpr хранятся примитивные литералы: int, double, bool, string или None.
+    // Нужно распознать, какой тип литерала и вернуть соответствующий объект.
+
+    // Предполагаем, что в классе LiteralExpr объявлено нечто вроде:
+    //   std::variant<std::monostate, int, double, bool, std::string> value;
+    // где:
+    //   - std::monostate обозначает литерал "None"
+    //   - int обозначает целое число
+    //   - double обозначает вещественное число
+    //   - bool обозначает литерал True/False
+    //   - std::string обозначает строковый литерал (без кавычек, уже распарсенный)
+
+    // Проверяем, какой вариант хранится в node.value:
+
+    // 1) None
+    if (std::holds_alternative<std::monostate>(node.value)) {
+        // Литерал None
+        ObjectPtr noneObj = py_none();
+        return noneObj;
+    }
+
+    // 2) Целое число
+    if (std::holds_alternative<long long>(node.value)) {
+        long long intVal = std::get<long long>(node.value);
+        ObjectPtr intObj = py_int(intVal);
+        return intObj;
+    }
+    if (std::holds_alternative<BigInt>(node.value)) {
+        return py_int(std::get<BigInt>(node.value));
+    }
+
+    // 3) Вещественное число (float)
+    if (std::holds_alternative<double>(node.value)) {
+        double dblVal = std::get<double>(node.value);
+        ObjectPtr floatObj = make_ref<PyFloat>(dblVal);
+        return floatObj;
+    }
+
+    // 4) Логическое значение (bool)
+    if (std::holds_alternative<bool>(node.value)) {
+        bool boolVal = std::get<bool>(node.value);
+        ObjectPtr boolObj = py_bool(boolVal);
+        return boolObj;
+    }
+
+    // 5) Строковый литерал
+    if (std::holds_alternative<std::string>(node.value)) {
+        // Предполагаем, что парсер убрал кавычки, и здесь передана «сырая» строка.
+        // Литералы интернируются: повторное вычисление того же узла (тело цикла)
+        // не создаёт новую строку, а равные литералы сравниваются по адресу.
+        if (!node.internedStr) {
+            node.internedStr = py_intern(std::get<std::string>(node.value)).get();
+        }
+        return ObjectPtr(node.internedStr);
+    }
+
+    // Если ни один тип не подошёл (например, в variant проскочил неизвестный тип),
+    // то лучше бросить ошибку на всякий случай.
+    throw RuntimeError(
+        "Line " + std::to_string(node.line)
+        + ": unsupported literal type"
+    );
+}
+
+// Тексты операторов в порядке BinOp/UnOp
+static const char *const BINARY_OP_TEXT[] = {
+    "+", "-", "*", "/", "|", "&", "^",
+    "==", "!=", "<", ">", "<=", ">=",
+    "and", "or", "in", "not in"
+};
+
+static const char *const UNARY_OP_TEXT[] = { "+", "-", "not" };
+
+BinOp binary_op_code(const std::string &op) {
+    for (size_t i = 0; i < std::size(BINARY_OP_TEXT); ++i) {
+        if (op == BINARY_OP_TEXT[i]) {
+            return static_cast<BinOp>(i);
+        }
+    }
+    return BinOp::Unsupported;
+}
+
+bool unary_op_code(const std::string &op, UnOp &code) {
+    for (size_t i = 0; i < std::size(UNARY_OP_TEXT); ++i) {
+        if (op == UNARY_OP_TEXT[i]) {
+            code = static_cast<UnOp>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *op_text(BinOp op) {
+    return op == BinOp::Unsupported ? "?" : BINARY_OP_TEXT[static_cast<size_t>(op)];
+}
+
+const char *op_text(UnOp op) {
+    return UNARY_OP_TEXT[static_cast<size_t>(op)];
+}
+
+static bool is_comparison(BinOp op) {
+    return op >= BinOp::Eq && op <= BinOp::Ge;
+}
+
+[[noreturn]] static void unsupported_binary_op(const std::string &op, int line) {
+    throw RuntimeError(
+        "Line " + std::to_string(line)
+        + ": unsupported binary operator '" + op + "'"
+    );
+}
+
+ObjectPtr binary_op(BinOp op, const ObjectPtr &left, const ObjectPtr &right, int line) {
+    // Операнды уже вычислены (слева направо) — здесь только сама операция.
+    switch (op) {
+        case BinOp::Add:    return left->__add__(right);
+        case BinOp::Sub:    return left->__sub__(right);
+        case BinOp::Mul:    return left->__mul__(right);
+        case BinOp::Div:    return left->__div__(right);
+        case BinOp::BitOr:  return left->__or__(right);
+        case BinOp::BitAnd: return left->__and__(right);
+        case BinOp::BitXor: return left->__xor__(right);
+
+        // Сравнения — через __eq__/__lt__ объектов (без форматирования в repr)
+        case BinOp::Eq:
+            return py_bool(left == right || left->__eq__(*right));
+        case BinOp::Ne:
+            return py_bool(left != right && !left->__eq__(*right));
+        case BinOp::Lt:
+        case BinOp::Gt:
+        case BinOp::Le:
+        case BinOp::Ge: {
+            bool comp = false;
+            // > и >= считаются как right < left: пару типов из ошибки разворачиваем обратно
+            bool flipped = op == BinOp::Gt || op == BinOp::Ge;
+            try {
+                if (op == BinOp::Lt)      comp = left->__lt__(*right);
+                else if (op == BinOp::Gt) comp = right->__lt__(*left);
+                else if (op == BinOp::Le) comp = left->__lt__(*right) || left->__eq__(*right);
+                else                      comp = right->__lt__(*left) || left->__eq__(*right);
+            } catch (const UnorderableError &err) {
+                // Типы — той пары, где сравнение споткнулось (у списков — элементов)
+                throw RuntimeError(
+                    "Line " + std::to_string(line)
+                    + " TypeError: '" + op_text(op) + "' not supported between instances of '"
+                    + kind_name(flipped ? err.right : err.left) + "' and '"
+                    + kind_name(flipped ? err.left : err.right) + "'"
+                );
+            }
+            return py_bool(comp);
+        }
+
+        // Логические возвращают один из операндов
+        case BinOp::And:
+            return is_truthy(left) ? right : left;
+        case BinOp::Or:
+            return is_truthy(left) ? left : right;
+
+        // in / not in
+        case BinOp::In:
+        case BinOp::NotIn: {
+            bool containsResult = false;
+            try {
+                containsResult = right->__contains__(left);
+            } catch (const RuntimeError &err) {
+                throw RuntimeError(
+                    "Line " + std::to_string(line)
+                    + " TypeError: " + err.what()
+                );
+            }
+            if (op == BinOp::NotIn) {
+                containsResult = !containsResult;
+            }
+            return py_bool(containsResult);
+        }
+
+        case BinOp::Unsupported:
+            break;
+    }
+    unsupported_binary_op(op_text(op), line);
+}
+
+
+ObjectPtr unary_op(UnOp op, const ObjectPtr &operand, int line) {
+    switch (op) {
+        // --- unary + ---
+        case UnOp::Plus: {
+            // В Python «+x» достаточно просто вернуть x, если x – число или булево
+            switch (operand->kind()) {
+                case Kind::Int:
+                case Kind::Float:
+                    // Можно вернуть тот же объект или создать новый – оставим тот же
+                    return operand;
+                case Kind::Bool:
+                    // Булево тоже интерпретируется как число 0/1 → возвращаем PyInt
+                    return py_int(static_cast<PyBool&>(*operand).get() ? 1 : 0);
+                default:
+                    break;
+            }
+            // Для остальных типов + недопустимо
+            std::string tname = deduceTypeName(operand);
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " TypeError: bad operand type for unary +: '" + tname + "'"
+            );
+        }
+
+        // --- unary - ---
+        case UnOp::Minus: {
+            switch (operand->kind()) {
+                case Kind::Int:
+                    return static_cast<PyInt&>(*operand).negate();
+                case Kind::Float:
+                    return make_ref<PyFloat>(- static_cast<PyFloat&>(*operand).get());
+                case Kind::Bool:
+                    // Булево как число: True → 1, False → 0
+                    return py_int(static_cast<PyBool&>(*operand).get() ? -1 : 0);
+                default:
+                    break;
+            }
+            // Все остальное – ошибка
+            std::string tname = deduceTypeName(operand);
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " TypeError: bad operand type for unary -: '" + tname + "'"
+            );
+        }
+
+        // --- logical not ---
+        case UnOp::Not:
+            return py_bool(!is_truthy(operand));
+    }
+    throw RuntimeError(
+        "Line " + std::to_string(line)
+        + " SyntaxError: invalid unary operator '" + op_text(op) + "'"
+    );
+}
+
+
+// Целочисленный индекс (bool → 0/1, как в Python); false — если индекс не число
+static bool int_index(const ObjectPtr &index, int64_t &idx) {
+    switch (index->kind()) {
+        case Kind::Int:  idx = static_cast<PyInt&>(*index).get(); return true;
+        case Kind::Bool: idx = static_cast<PyBool&>(*index).get() ? 1 : 0; return true;
+        default:         return false;
+    }
+}
+
+ObjectPtr get_index(const ObjectPtr &base, const ObjectPtr &index, int line) {
+    // Определяем вид «базового» объекта и применяем правила Python для индексирования.
+    if (!base) {
+    throw RuntimeError("Line ...: internal error: base is null");
+    }
+    if (!index) {
+    throw RuntimeError("Line ...: internal error: index is null");
+    }
+
+    switch (base->kind()) {
+    // --- 3.1) Строка: разрешаем только целочисленные индексы (bool → int тоже)
+    case Kind::String: {
+        int64_t idx;
+        if (!int_index(index, idx)) {
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " TypeError: string indices must be integers"
+            );
+        }
+
+        const auto &str = static_cast<PyString&>(*base);
+        int64_t length = static_cast<int64_t>(str.size());
+
+        // В Python разрешены отрицательные индексы
+        if (idx < 0) {
+            idx += length;
+        }
+
+        // Проверяем диапазон
+        if (idx < 0 || idx >= length) {
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " IndexError: string index out of range"
+            );
+        }
+
+        // Символ возвращаем как строку длины 1 (готовую, см. py_char)
+        return py_char(str.get()[idx]);
+    }
+
+    // --- 3.2) Список: разрешаем целочисленные индексы (bool → int тоже)
+    case Kind::List: {
+        int64_t idx;
+        if (!int_index(index, idx)) {
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " TypeError: list indices must be integers"
+            );
+        }
+
+        const PyList &list = static_cast<PyList&>(*base);
+        int64_t length = static_cast<int64_t>(list.size());
+        if (idx < 0) {
+            idx += length;
+        }
+        if (idx < 0 || idx >= length) {
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " IndexError: list index out of range"
+            );
+        }
+        return list.item(idx);
+    }
+
+    // --- 3.2a) Кортеж: так же, как список
+    case Kind::Tuple: {
+        int64_t idx;
+        if (!int_index(index, idx)) {
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " TypeError: tuple indices must be integers"
+            );
+        }
+
+        const PyTuple &tuple = static_cast<PyTuple&>(*base);
+        int64_t length = static_cast<int64_t>(tuple.size());
+        if (idx < 0) {
+            idx += length;
+        }
+        if (idx < 0 || idx >= length) {
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " IndexError: tuple index out of range"
+            );
+        }
+        return tuple.item(idx);
+    }
+
+    // --- 3.3) Словарь: index может быть любым объектом.
+    case Kind::Dict:
+        // Просто вызываем __getitem__; если ключа нет — KeyError бросят там
+        try {
+            return base->__getitem__(index);
+        }
+        catch (const RuntimeError &err) {
+            // Сообщение от PyDict: "KeyError: <repr(key)>"
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " " + err.what()
+            );
+        }
+
+    // --- 3.4) Множество: в Python множеству нельзя делать индексирование
+    case Kind::Set:
+        throw RuntimeError(
+            "Line " + std::to_string(line)
+            + " TypeError: 'set' object is not subscriptable"
+        );
+
+    default:
+        break;
+    }
+
+    // --- 3.5) Для любых других объектов пробуем вызвать __getitem__ напрямую.
+    //        Если __getitem__ не поддерживается, он бросит RuntimeError("object is not subscriptable").
+    try {
+        ObjectPtr result = base->__getitem__(index);
+        return result;
+    }
+    catch (const RuntimeError &err) {
+        // Добавляем информацию о строке
+        throw RuntimeError(
+            "Line " + std::to_string(line)
+            + " TypeError: " + err.what()
+        );
+    }
+}
+
+
+// "Line X TypeError: 'TYPE' object has no attribute 'name'"
+[[noreturn]] static void attribute_error(const ObjectPtr &base, const Ref<PyString> &name, int line) {
+    // Определим, какого «типа» объект, чтобы сообщение было понятнее.
+    std::string typeName = deduceTypeName(base);
+    throw RuntimeError(
+        "Line " + std::to_string(line)
+        + " TypeError: '" + typeName
+        + "' object has no attribute '" + name->get() + "'"
+    );
+}
+
+ObjectPtr get_attribute(const ObjectPtr &base, const Ref<PyString> &name, int line) {
+    // Пытаемся получить атрибут через виртуальный метод __getattr__.
+    //    Если объект не поддерживает данный атрибут, __getattr__ бросит RuntimeError
+    //    с сообщением "object has no attribute '...'" или подобным.
+    try {
+        return base->__getattr__(name);
+    }
+    catch (const RuntimeError &err) {
+        // Если __getattr__ бросил ошибку, превращаем её в TypeError с указанием строки
+        //    в формате Python.
+        attribute_error(base, name, line);
+    }
+}
+
+ObjectPtr get_attribute(const ObjectPtr &base, const Ref<PyString> &name, AttrCache &cache, int line) {
+    // Атрибут экземпляра: при попадании в кэш — сразу слот, а если
+    // у экземпляра его нет — сразу поиск в классе (метод, поле класса)
+    if (base->kind() == Kind::Instance) {
+        auto &instance = static_cast<PyInstance&>(*base);
+        ObjectPtr *slot = instance.slot_for(*name, cache);
+        if (slot && *slot) {
+            return *slot;
+        }
+        try {
+            return instance.classPtr->__getattr__(name);
+        }
+        catch (const RuntimeError &err) {
+            attribute_error(base, name, line);
+        }
+    }
+    return get_attribute(base, name, line);
+}
+
+void set_attribute(const ObjectPtr &base, const Ref<PyString> &name, ObjectPtr value, AttrCache &cache, int line) {
+    if (base->kind() == Kind::Instance) {
+        auto &instance = static_cast<PyInstance&>(*base);
+        if (ObjectPtr *slot = instance.slot_for(*name, cache)) {
+            *slot = std::move(value);
+            return;
+        }
+        // Нового атрибута в форме нет — __setattr__ переведёт экземпляр в следующую
+        // (или откажет, если набор атрибутов фиксирован __slots__)
+        if (instance.classPtr->fixed_layout()) {
+            attribute_error(base, name, line);
+        }
+        instance.__setattr__(name, std::move(value));
+        return;
+    }
+    base->__setattr__(name, std::move(value));
+}
+
+
+
+
+ObjectPtr build_dict(const std::vector<ObjectPtr> &keysAndValues, int line) {
+    // Ключи и значения уже вычислены слева направо; вставляем пары по порядку.
+    // В PyDict __setitem__ реализован так, что если ключа ещё нет, он создаётся,
+    // а если ключ уже есть (repr совпадает), значение перезаписывается.
+    auto dictObj = make_ref<PyDict>();
+    for (size_t i = 0; i + 1 < keysAndValues.size(); i += 2) {
+        try {
+            dictObj->__setitem__(keysAndValues[i], keysAndValues[i + 1]);
+        }
+        catch (const RuntimeError &err) {
+            // Если __setitem__ бросил ошибку, превращаем её в TypeError с указанием строки
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " TypeError: " + err.what()
+            );
+        }
+    }
+    return dictObj;
+}
+
+ObjectPtr build_set(std::vector<ObjectPtr> elems, int line) {
+    // Проверяем «hashability» элементов.
+    // В нашей модели list, dict и set считать «нехэшируемыми»:
+    // отбрасываем их с TypeError.
+    for (const auto &elemVal : elems) {
+        Kind kind = elemVal->kind();
+        if (kind == Kind::List || kind == Kind::Dict || kind == Kind::Set) {
+            throw RuntimeError(
+                "Line " + std::to_string(line)
+                + " TypeError: unhashable type: '" + deduceTypeName(elemVal) + "'"
+            );
+        }
+    }
+
+    // Конструктор PySet уберёт дубли (по __hash__/__eq__).
+    return make_ref<PySet>(std::move(elems));
+}
+
+void raise_assertion(const ObjectPtr &message, int line) {
+    // В Python бывает просто "AssertionError",
+    // или "AssertionError: <message>" (repr() сообщения).
+    std::string errorText = "AssertionError";
+    if (message) {
+        std::string text = message->repr();
+        if (!text.empty()) {
+            errorText += ": ";
+            errorText += text;
+        }
+    }
+
+    throw RuntimeError(
+        "Line " + std::to_string(line) + " " + errorText
+    );
+}
+
+void exit_program(const ObjectPtr &value) {
+    // Эмулируем SystemExit: если аргумент — целое число, используем его как код возврата;
+    // если это любой другой объект, печатаем его и возвращаем код 1.
+    // exit() без аргументов → код 0.
+    int exitCode = 0;
+    if (value) {
+        // Если это PyInt или PyBool или PyFloat, пытаемся получить целое:
+        switch (value->kind()) {
+            case Kind::Int:
+                exitCode = static_cast<int>(static_cast<PyInt&>(*value).get());
+                break;
+            case Kind::Bool:
+                // True → 1, False → 0
+                exitCode = static_cast<PyBool&>(*value).get() ? 1 : 0;
+                break;
+            case Kind::Float:
+                // Приводим к int (отбрасываем дробную часть)
+                exitCode = static_cast<int>(static_cast<PyFloat&>(*value).get());
+                break;
+            default:
+                // Любой другой объект: печатаем его repr() как текст на stderr и выходим с кодом 1
+                std::cerr << value->repr() << std::endl;
+                std::exit(1);
+        }
+    }
+
+    std::exit(exitCode);
+}
+
+
+bool is_truthy(const Value &value) {
+    switch (value.kind()) {
+        case Value::Tag::None:  return false;
+        case Value::Tag::Bool:  return value.as_bool();
+        case Value::Tag::Int:   return value.as_int() != 0;
+        case Value::Tag::Float: return value.as_float() != 0.0;
+        default:                return is_truthy(value.object());
+    }
+}
+
+Value literal_as_value(const LiteralExpr &node) {
+    if (std::holds_alternative<std::monostate>(node.value)) {
+        return Value::none();
+    }
+    if (std::holds_alternative<long long>(node.value)) {
+        return Value::integer(std::get<long long>(node.value));
+    }
+    if (std::holds_alternative<double>(node.value)) {
+        return Value::real(std::get<double>(node.value));
+    }
+    if (std::holds_alternative<bool>(node.value)) {
+        return Value::boolean(std::get<bool>(node.value));
+    }
+    return Value(literal_value(node));
+}
+
+// Сравнение двух чисел одного типа (op — одно из Eq..Ge)
+template <class T>
+static Value compare_numbers(BinOp op, T a, T b) {
+    switch (op) {
+        case BinOp::Eq: return Value::boolean(a == b);
+        case BinOp::Ne: return Value::boolean(a != b);
+        case BinOp::Lt: return Value::boolean(a < b);
+        case BinOp::Gt: return Value::boolean(a > b);
+        case BinOp::Le: return Value::boolean(a <= b);
+        default:        return Value::boolean(a >= b);
+    }
+}
+
+Value binary_op(BinOp op, const Value &left, const Value &right, int line) {
+    using Tag = Value::Tag;
+    Tag lt = left.kind();
+    Tag rt = right.kind();
+    bool leftNumber = lt == Tag::Int || lt == Tag::Float;
+    bool rightNumber = rt == Tag::Int || rt == Tag::Float;
+
+    // Арифметика int/float (кроме '/', у которого своя проверка деления на ноль)
+    if (leftNumber && rightNumber) {
+        if (lt == Tag::Int && rt == Tag::Int) {
+            // При переполнении int64_t — дальше, в PyInt (там результат станет BigInt)
+            int64_t a = left.as_int();
+            int64_t b = right.as_int();
+            int64_t r;
+            switch (op) {
+                case BinOp::Add: if (!__builtin_add_overflow(a, b, &r)) return Value::integer(r); break;
+                case BinOp::Sub: if (!__builtin_sub_overflow(a, b, &r)) return Value::integer(r); break;
+                case BinOp::Mul: if (!__builtin_mul_overflow(a, b, &r)) return Value::integer(r); break;
+                case BinOp::BitOr:  return Value::integer(a | b);
+                case BinOp::BitAnd: return Value::integer(a & b);
+                case BinOp::BitXor: return Value::integer(a ^ b);
+                default: break;
+            }
+        } else {
+            double a = lt == Tag::Int ? left.as_int() : left.as_float();
+            double b = rt == Tag::Int ? right.as_int() : right.as_float();
+            switch (op) {
+                case BinOp::Add: return Value::real(a + b);
+                case BinOp::Sub: return Value::real(a - b);
+                case BinOp::Mul: return Value::real(a * b);
+                default: break;
+            }
+        }
+    }
+
+    // Сравнения чисел — прямо над int/double, без объектов
+    if (leftNumber && rightNumber && is_comparison(op)) {
+        if (lt == Tag::Int && rt == Tag::Int) {
+            return compare_numbers(op, left.as_int(), right.as_int());
+        } else if (lt == Tag::Float && rt == Tag::Float) {
+            return compare_numbers(op, left.as_float(), right.as_float());
+        } else {
+            // int с float — точно, без округления int до double
+            double f = lt == Tag::Float ? left.as_float() : right.as_float();
+            if (std::isnan(f)) {
+                return Value::boolean(op == BinOp::Ne);
+            }
+            int c = lt == Tag::Int ? compare_int_float(left.as_int(), f) : -compare_int_float(right.as_int(), f);
+            return compare_numbers(op, c, 0);
+        }
+    }
+
+    // and/or возвращают один из операндов
+    if (op == BinOp::And) {
+        return is_truthy(left) ? right : left;
+    }
+    if (op == BinOp::Or) {
+        return is_truthy(left) ? left : right;
+    }
+
+    return Value(binary_op(op, left.object(), right.object(), line));
+}
+
+Value unary_op(UnOp op, const Value &operand, int line) {
+    using Tag = Value::Tag;
+    Tag t = operand.kind();
+    switch (op) {
+        case UnOp::Minus:
+            if (t == Tag::Int && operand.as_int() != INT64_MIN) return Value::integer(-operand.as_int());
+            if (t == Tag::Float) return Value::real(-operand.as_float());
+            break;
+        case UnOp::Plus:
+            if (t == Tag::Int || t == Tag::Float) return operand;
+            break;
+        case UnOp::Not:
+            return Value::boolean(!is_truthy(operand));
+    }
+    return Value(unary_op(op, operand.object(), line));
+}
+
+Value binary_op(const std::string &op, const Value &left, const Value &right, int line) {
+    BinOp code = binary_op_code(op);
+    if (code == BinOp::Unsupported) {
+        unsupported_binary_op(op, line);
+    }
+    return binary_op(code, left, right, line);
+}
+
+Value unary_op(const std::string &op, const Value &operand, int line) {
+    UnOp code;
+    if (!unary_op_code(op, code)) {
+        throw RuntimeError(
+            "Line " + std::to_string(line)
+            + " SyntaxError: invalid unary operator '" + op + "'"
+        );
+    }
+    return unary_op(code, operand, line);
+}
+
+Value get_index(const Value &base, const Value &index, int line) {
+    // Список по целому индексу в пределах — элемент прямо из буфера;
+    // остальное (и сообщения об ошибках) — как у версии для объектов
+    if (index.is_int() && base.is_object() && base.ref()->kind() == Kind::List) {
+        const ListBuffer &elems = *static_cast<PyList&>(*base.ref()).buffer();
+        int64_t length = static_cast<int64_t>(elems.size());
+        int64_t idx = index.as_int();
+        if (idx < 0) {
+            idx += length;
+        }
+        if (idx >= 0 && idx < length) {
+            return list_item(elems, idx);
+        }
+    }
+    return Value(get_index(base.object(), index.object(), line));
+}
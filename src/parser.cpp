@@ -771,9 +771,9 @@ expression Parser::parse_not() {
 }
 
 
-// <comparison_expr> = <arith_expr> (('==' | '!=' | '<' | '>' | '<=' | '>=') <arith_expr>)*
+// <comparison_expr> = <bitor_expr> (('==' | '!=' | '<' | '>' | '<=' | '>=') <bitor_expr>)*
 expression Parser::parse_comparison() {
-    expression left = parse_arith();
+    expression left = parse_bitor();
 
     while (!is_end()) {
         Token opTok = peek();
@@ -787,7 +787,7 @@ expression Parser::parse_comparison() {
             Token taken = advance();
             int comp_line = taken.line;
             std::string op = taken.value;
-            expression right = parse_arith();
+            expression right = parse_bitor();
             left = std::make_unique<BinaryExpr>(
                 std::move(left),
                 op,
@@ -802,6 +802,60 @@ expression Parser::parse_comparison() {
 }
 
 
+// Битовые операторы — между сравнениями и арифметикой, как в Python:
+// <bitor_expr>  = <bitxor_expr> ('|' <bitxor_expr>)*
+// <bitxor_expr> = <bitand_expr> ('^' <bitand_expr>)*
+// <bitand_expr> = <arith_expr> ('&' <arith_expr>)*
+// Для множеств это объединение, симметрическая разность и пересечение.
+expression Parser::parse_bitor() {
+    expression left = parse_bitxor();
+
+    while (!is_end() && peek().type == TokenType::VBAR) {
+        Token opTok = advance();
+        expression right = parse_bitxor();
+        left = std::make_unique<BinaryExpr>(
+            std::move(left),
+            opTok.value,
+            std::move(right),
+            opTok.line
+        );
+    }
+    return left;
+}
+
+expression Parser::parse_bitxor() {
+    expression left = parse_bitand();
+
+    while (!is_end() && peek().type == TokenType::CIRCUMFLEX) {
+        Token opTok = advance();
+        expression right = parse_bitand();
+        left = std::make_unique<BinaryExpr>(
+            std::move(left),
+            opTok.value,
+            std::move(right),
+            opTok.line
+        );
+    }
+    return left;
+}
+
+expression Parser::parse_bitand() {
+    expression left = parse_arith();
+
+    while (!is_end() && peek().type == TokenType::AMPER) {
+        Token opTok = advance();
+        expression right = parse_arith();
+        left = std::make_unique<BinaryExpr>(
+            std::move(left),
+            opTok.value,
+            std::move(right),
+            opTok.line
+        );
+    }
+    return left;
+}
+
+
 // <arith_expr> = <term> (('+' | '-' | '+=' | '-=') <term>)* 
 expression Parser::parse_arith() {
     expression left = parse_term();
@@ -931,8 +985,13 @@ expression Parser::parse_primary() {
     // Целое число
     if (token.type == TokenType::INTNUM) {
         advance();
-        int ival = std::stoi(token.value);
-        return std::make_unique<LiteralExpr>(ival, token.line);
+        // Целые любой длины: что не влезает в long long — сразу BigInt
+        try {
+            long long ival = std::stoll(token.value);
+            return std::make_unique<LiteralExpr>(ival, token.line);
+        } catch (const std::out_of_range &) {
+            return std::make_unique<LiteralExpr>(BigInt::from_string(token.value), token.line);
+        }
     }
     // Вещественное
     else if (token.type == TokenType::FLOATNUM) {
@@ -940,10 +999,10 @@ expression Parser::parse_primary() {
         double dval = std::stod(token.value);
         return std::make_unique<LiteralExpr>(dval, token.line);
     }
-    // Строковый литерал
+    // Строковый литерал (с постфиксами: ", ".join(parts), "abc"[0])
     else if (token.type == TokenType::STRING) {
         advance();
-        return std::make_unique<LiteralExpr>(token.value, token.line);
+        return parse_postfix(std::make_unique<LiteralExpr>(token.value, token.line));
     }
     // Булевое
     else if (token.type == TokenType::BOOL) {
@@ -1052,7 +1111,7 @@ expression Parser::parse_primary() {
         return std::make_unique<ListExpr>(std::move(elems), list_line);
     }
 
-    // Словарь 
+    // Словарь или множество
     else if (token.type == TokenType::LBRACE) {
         Token leftBrace = advance();
         int brace_line = leftBrace.line;
@@ -1068,6 +1127,22 @@ expression Parser::parse_primary() {
         }
 
         auto firstKey = parse_expression();
+
+        // Без ':' после первого выражения — это литерал множества {e1, e2, …}
+        // ({} остаётся пустым словарём, как в Python)
+        if (peek().type != TokenType::COLON) {
+            std::vector<std::unique_ptr<Expression>> elems;
+            elems.push_back(std::move(firstKey));
+            while (match(TokenType::COMMA)) {
+                if (peek().type == TokenType::RBRACE) {
+                    break;
+                }
+                elems.push_back(parse_expression());
+            }
+            extract(TokenType::RBRACE);
+            return std::make_unique<SetExpr>(std::move(elems), brace_line);
+        }
+
         extract(TokenType::COLON);
         auto firstVal = parse_expression();
 
@@ -0,0 +1,13 @@
+#include "pool.hpp"
+
+// Страница нарезается лениво: allocate сдвигает cursor на блок за раз.
+// Хвост прежней страницы (меньше одного блока) пропадает.
+void Pool::refill(std::size_t ix) {
+    SizeClass &cls = classes[ix];
+    std::size_t block = block_size(ix);
+    char *slab = static_cast<char*>(::operator new(SLAB_SIZE));
+    slabs.push_back(slab);
+    totals.slabBytes += SLAB_SIZE;
+    cls.cursor = slab;
+    cls.end = slab + SLAB_SIZE / block * block;
+}
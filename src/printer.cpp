@@ -441,9 +441,13 @@ void ASTPrinterVisitor::visit(LiteralExpr &node) {
     std::string valStr;
 
     // Определяем, какой тип лежит в variant
-    if (std::holds_alternative<int>(node.value)) {
+    if (std::holds_alternative<long long>(node.value)) {
         typeStr = "INT";
-        valStr = std::to_string(std::get<int>(node.value));
+        valStr = std::to_string(std::get<long long>(node.value));
+    }
+    else if (std::holds_alternative<BigInt>(node.value)) {
+        typeStr = "INT";
+        valStr = std::get<BigInt>(node.value).to_string();
     }
     else if (std::holds_alternative<double>(node.value)) {
         typeStr = "FLOAT";
@@ -0,0 +1,381 @@
+#include "resolver.hpp"
+
+#include <algorithm>
+
+
+void Resolver::resolve(TransUnit &unit) {
+    // 1) Собираем локальные и прочитанные имена каждой функции
+    pass = Pass::Collect;
+    current = nullptr;
+    unit.accept(*this);
+
+    // 2) Решаем, какие переменные становятся ячейками, и нумеруем ячейки
+    link_free_variables();
+
+    // 3) Записываем привязки в узлы AST
+    pass = Pass::Annotate;
+    current = nullptr;
+    unit.accept(*this);
+}
+
+// Для каждой функции F и каждого прочитанного ею нелокального имени ищем
+// ближайшую объемлющую функцию A, где это имя локальное. Если нашли —
+// в A имя становится cellvar, а во всех функциях от F до A (не включая A) — freevar.
+// Если не нашли — имя глобальное, ничего делать не нужно.
+void Resolver::link_free_variables() {
+    auto add_unique = [](std::vector<std::string> &vec, const std::string &name) {
+        if (std::find(vec.begin(), vec.end(), name) == vec.end()) {
+            vec.push_back(name);
+        }
+    };
+
+    for (auto &fn : functions) {
+        for (const auto &name : fn->used) {
+            if (fn->locals.count(name)) {
+                continue;
+            }
+
+            FunctionInfo *owner = fn->parent;
+            while (owner && !owner->locals.count(name)) {
+                owner = owner->parent;
+            }
+            if (!owner) {
+                continue;   // глобальное имя
+            }
+
+            add_unique(owner->cellvars, name);
+            for (FunctionInfo *f = fn.get(); f != owner; f = f->parent) {
+                add_unique(f->freevars, name);
+            }
+        }
+    }
+
+    // Нумеруем ячейки: сначала cellvars, затем freevars.
+    // functions идут в порядке обхода, поэтому ячейки родителя
+    // пронумерованы раньше, чем к ним обратятся freeSources детей.
+    for (auto &fn : functions) {
+        FuncDecl *decl = fn->decl;
+        size_t nparams = decl->posParams.size() + decl->defaultParams.size();
+
+        decl->nlocals = static_cast<int>(fn->localNames.size());
+        decl->localNames = fn->localNames;
+        decl->cellNames.clear();
+        decl->cellParamSlot.clear();
+        decl->freeSources.clear();
+
+        for (const auto &name : fn->cellvars) {
+            fn->cells[name] = static_cast<int>(decl->cellNames.size());
+            decl->cellNames.push_back(name);
+            int slot = fn->locals.at(name);
+            decl->cellParamSlot.push_back(static_cast<size_t>(slot) < nparams ? slot : -1);
+        }
+        decl->ncellvars = fn->cellvars.size();
+
+        for (const auto &name : fn->freevars) {
+            fn->cells[name] = static_cast<int>(decl->cellNames.size());
+            decl->cellNames.push_back(name);
+            decl->freeSources.push_back(fn->parent->cells.at(name));
+        }
+    }
+}
+
+NameRef Resolver::ref_for(const std::string &name) const {
+    NameRef ref;
+    if (!current) {
+        return ref;     // уровень модуля — Global
+    }
+    auto cell = current->cells.find(name);
+    if (cell != current->cells.end()) {
+        ref.scope = NameScope::Cell;
+        ref.slot = cell->second;
+        return ref;
+    }
+    auto local = current->locals.find(name);
+    if (local != current->locals.end()) {
+        ref.scope = NameScope::Local;
+        ref.slot = local->second;
+        return ref;
+    }
+    return ref;
+}
+
+void Resolver::bind(const std::string &name, NameRef &ref) {
+    if (pass == Pass::Annotate) {
+        ref = ref_for(name);
+        return;
+    }
+    if (current && !current->locals.count(name)) {
+        current->locals[name] = static_cast<int>(current->localNames.size());
+        current->localNames.push_back(name);
+    }
+}
+
+void Resolver::use(const std::string &name, NameRef &ref) {
+    if (pass == Pass::Annotate) {
+        ref = ref_for(name);
+        return;
+    }
+    if (current && current->usedSet.insert(name).second) {
+        current->used.push_back(name);
+    }
+}
+
+void Resolver::function(FuncDecl &node, bool bindName) {
+    // default-значения вычисляются при объявлении — в объемлющем контексте
+    for (auto &pr : node.defaultParams) {
+        accept(pr.second.get());
+    }
+    if (bindName) {
+        bind(node.name, node.nameRef);
+    }
+
+    FunctionInfo *saved = current;
+    if (pass == Pass::Collect) {
+        auto info = std::make_unique<FunctionInfo>();
+        info->decl = &node;
+        info->parent = current;
+        current = info.get();
+        infoByDecl[&node] = info.get();
+        functions.push_back(std::move(info));
+
+        // параметры занимают первые слоты — в том же порядке, в каком их связывает call_function
+        NameRef unused;
+        for (const auto &name : node.posParams) {
+            bind(name, unused);
+        }
+        for (const auto &pr : node.defaultParams) {
+            bind(pr.first, unused);
+        }
+    } else {
+        current = infoByDecl.at(&node);
+    }
+
+    accept(node.body.get());
+    current = saved;
+}
+
+void Resolver::visit(TransUnit &node) {
+    for (auto &unit : node.units) {
+        accept(unit.get());
+    }
+}
+
+void Resolver::visit(FuncDecl &node) {
+    function(node, true);
+}
+
+void Resolver::visit(ClassDecl &node) {
+    node.baseRefs.resize(node.baseClasses.size());
+    for (size_t i = 0; i < node.baseClasses.size(); ++i) {
+        use(node.baseClasses[i], node.baseRefs[i]);
+    }
+    bind(node.name, node.nameRef);
+
+    // Поля вычисляются в объемлющем контексте, а методы — обычные функции,
+    // чьё имя попадает в словарь класса, а не в локальные переменные.
+    for (auto &field : node.fields) {
+        accept(field->initExpr.get());
+    }
+    for (auto &method : node.methods) {
+        function(*method, false);
+    }
+}
+
+void Resolver::visit(BlockStat &node) {
+    for (auto &stat : node.statements) {
+        accept(stat.get());
+    }
+}
+
+void Resolver::visit(ExprStat &node) {
+    accept(node.expr.get());
+}
+
+void Resolver::visit(AssignStat &node) {
+    accept(node.right.get());
+    if (auto id = dynamic_cast<IdExpr*>(node.left.get())) {
+        bind(id->name, id->ref);
+    } else {
+        accept(node.left.get());
+    }
+}
+
+void Resolver::visit(IdExpr &node) {
+    use(node.name, node.ref);
+}
+
+void Resolver::visit(LiteralExpr &node) {}
+
+void Resolver::visit(BinaryExpr &node) {
+    accept(node.left.get());
+    accept(node.right.get());
+}
+
+void Resolver::visit(UnaryExpr &node) {
+    accept(node.operand.get());
+}
+
+void Resolver::visit(PrimaryExpr &node) {
+    accept(node.literalExpr.get());
+    accept(node.idExpr.get());
+    accept(node.callExpr.get());
+    accept(node.indexExpr.get());
+    accept(node.parenExpr.get());
+    accept(node.ternaryExpr.get());
+}
+
+void Resolver::visit(CallExpr &node) {
+    accept(node.caller.get());
+    for (auto &arg : node.arguments) {
+        accept(arg.get());
+    }
+}
+
+void Resolver::visit(IndexExpr &node) {
+    accept(node.base.get());
+    accept(node.index.get());
+}
+
+void Resolver::visit(AttributeExpr &node) {
+    accept(node.obj.get());
+}
+
+void Resolver::visit(ListExpr &node) {
+    for (auto &elem : node.elems) {
+        accept(elem.get());
+    }
+}
+
+void Resolver::visit(DictExpr &node) {
+    for (auto &item : node.items) {
+        accept(item.first.get());
+        accept(item.second.get());
+    }
+}
+
+void Resolver::visit(SetExpr &node) {
+    for (auto &elem : node.elems) {
+        accept(elem.get());
+    }
+}
+
+void Resolver::visit(TernaryExpr &node) {
+    accept(node.trueExpr.get());
+    accept(node.condition.get());
+    accept(node.falseExpr.get());
+}
+
+void Resolver::visit(CondStat &node) {
+    accept(node.condition.get());
+    accept(node.ifblock.get());
+    for (auto &elif : node.elifblocks) {
+        accept(elif.first.get());
+        accept(elif.second.get());
+    }
+    accept(node.elseblock.get());
+}
+
+void Resolver::visit(WhileStat &node) {
+    accept(node.condition.get());
+    accept(node.body.get());
+}
+
+void Resolver::visit(ForStat &node) {
+    accept(node.iterable.get());
+    node.iteratorRefs.resize(node.iterators.size());
+    for (size_t i = 0; i < node.iterators.size(); ++i) {
+        bind(node.iterators[i], node.iteratorRefs[i]);
+    }
+    accept(node.body.get());
+}
+
+// Вызов, результат которого сразу возвращается: return f(...) или return (f(...))
+static CallExpr *tail_call_of(Expression *expr) {
+    if (auto call = dynamic_cast<CallExpr*>(expr)) {
+        return call;
+    }
+    if (auto primary = dynamic_cast<PrimaryExpr*>(expr)) {
+        if (primary->type == PrimaryExpr::PrimaryType::CALL) {
+            return tail_call_of(primary->callExpr.get());
+        }
+        if (primary->type == PrimaryExpr::PrimaryType::PAREN) {
+            return tail_call_of(primary->parenExpr.get());
+        }
+    }
+    return nullptr;
+}
+
+void Resolver::visit(ReturnStat &node) {
+    accept(node.expr.get());
+    if (pass == Pass::Annotate && current) {
+        node.tailCall = tail_call_of(node.expr.get());
+    }
+}
+
+void Resolver::visit(BreakStat &node) {}
+
+void Resolver::visit(ContinueStat &node) {}
+
+void Resolver::visit(PassStat &node) {}
+
+void Resolver::visit(AssertStat &node) {
+    accept(node.condition.get());
+    accept(node.message.get());
+}
+
+void Resolver::visit(ExitStat &node) {
+    accept(node.expr.get());
+}
+
+void Resolver::visit(PrintStat &node) {
+    accept(node.expr.get());
+}
+
+// Переменная генератора живёт в той же области, что и сам генератор
+// (внутри функции — локальный слот, на уровне модуля — глобальное имя).
+void Resolver::visit(ListComp &node) {
+    accept(node.iterableExpr.get());
+    bind(node.iterVar, node.iterRef);
+    accept(node.valueExpr.get());
+}
+
+void Resolver::visit(DictComp &node) {
+    accept(node.iterableExpr.get());
+    bind(node.iterVar, node.iterRef);
+    accept(node.keyExpr.get());
+    accept(node.valueExpr.get());
+}
+
+void Resolver::visit(TupleComp &node) {
+    accept(node.iterableExpr.get());
+    bind(node.iterVar, node.iterRef);
+    accept(node.valueExpr.get());
+}
+
+void Resolver::visit(LambdaExpr &node) {
+    // Один раз оборачиваем тело лямбды в ReturnStat внутри собственного FuncDecl —
+    // дальше лямбда ничем не отличается от обычной функции без имени.
+    if (!node.decl) {
+        auto returnStmt = std::make_unique<ReturnStat>(std::move(node.body), node.line);
+        node.decl = std::make_unique<FuncDecl>(
+            "<lambda>",
+            node.params,
+            std::vector<std::pair<std::string, std::unique_ptr<Expression>>>{},
+            std::move(returnStmt),
+            node.line
+        );
+    }
+    function(*node.decl, false);
+}
+
+void Resolver::visit(LenStat &node) {
+    accept(node.expr.get());
+}
+
+void Resolver::visit(DirStat &node) {
+    accept(node.expr.get());
+}
+
+void Resolver::visit(EnumerateStat &node) {
+    accept(node.expr.get());
+}
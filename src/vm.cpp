@@ -0,0 +1,522 @@
+#include "executer.hpp"
+#include "bytecode.hpp"
+#include "operations.hpp"
+
+#include <iostream>
+#include <iterator>
+
+
+// Стековая машина режима --stackless.
+//
+// Вызов пользовательской функции (CALL) не рекурсирует в C++: он кладёт
+// в frames новый кадр, запоминает в нём, куда вернуться (returnCode/returnPc),
+// и просто переключает текущий код на тело функции. RETURN_VALUE снимает кадр
+// и продолжает вызывающего с сохранённого адреса. Поэтому глубина рекурсии
+// Python-кода упирается только в options.recursionLimit (проверка в push_frame),
+// а frames, local_slots и value_stack растут в куче.
+//
+// Сообщения об ошибках совпадают с обходчиком AST: операции вызывают
+// те же функции из operations.hpp, а вызовы оборачивают ошибки так же,
+// как visit(CallExpr) и PyClass::__call__.
+//
+// Стек значений и локальные слоты хранят Value (см. value.hpp): скаляры
+// упаковываются в объекты только на входе в контейнеры, глобальные имена
+// и встроенные функции — отсюда box_values.
+
+static std::vector<ObjectPtr> box_values(const Value *values, size_t count) {
+    std::vector<ObjectPtr> boxed;
+    boxed.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        boxed.push_back(values[i].object());
+    }
+    return boxed;
+}
+
+Value Executor::run_code(const CodeObject &entry, size_t stopDepth) {
+    const CodeObject *code = &entry;
+    size_t pc = 0;
+    size_t base = frames.empty() ? 0 : frames.back().base;
+    const size_t entryStack = value_stack.size();
+    if (stopDepth > 0) {
+        frames.back().stackBase = entryStack;   // кадр входа (из call_function)
+    }
+
+    // Снять верхний кадр и продолжить вызывающего с результатом result
+    auto return_to_caller = [&](Value result) {
+        Frame &frame = frames.back();
+        code = frame.returnCode;
+        pc = frame.returnPc;
+        pop_frame();
+        base = frames.empty() ? 0 : frames.back().base;
+        value_stack.push_back(std::move(result));
+    };
+
+    try {
+        while (pc < code->code.size()) {
+            const Instr &ins = code->code[pc++];
+
+            switch (ins.op) {
+            case OpCode::LOAD_CONST:
+                value_stack.push_back(code->consts[ins.arg]);
+                break;
+
+            case OpCode::LOAD_LOCAL: {
+                const Value &value = local_slots[base + ins.arg];
+                if (value.empty()) {
+                    throw RuntimeError(
+                        "Line " + std::to_string(ins.line) + ": local variable '"
+                        + frames.back().function->getDecl()->localNames[ins.arg]
+                        + "' referenced before assignment"
+                    );
+                }
+                value_stack.push_back(value);
+                break;
+            }
+
+            case OpCode::STORE_LOCAL:
+                local_slots[base + ins.arg] = std::move(value_stack.back());
+                value_stack.pop_back();
+                break;
+
+            case OpCode::LOAD_CELL: {
+                const ObjectPtr &value = frames.back().cells[ins.arg]->value;
+                if (!value) {
+                    throw RuntimeError(
+                        "Line " + std::to_string(ins.line) + ": free variable '"
+                        + frames.back().function->getDecl()->cellNames[ins.arg]
+                        + "' referenced before assignment in enclosing scope"
+                    );
+                }
+                value_stack.push_back(value);
+                break;
+            }
+
+            case OpCode::STORE_CELL:
+                frames.back().cells[ins.arg]->value = pop().object();
+                break;
+
+            case OpCode::LOAD_GLOBAL:
+                value_stack.push_back(load_name(NameRef{}, code->names[ins.arg], ins.line));
+                break;
+
+            case OpCode::STORE_GLOBAL: {
+                store_name(NameRef{}, code->names[ins.arg], pop(),
+                           static_cast<SymbolType>(ins.arg2));
+                break;
+            }
+
+            case OpCode::POP_TOP:
+                value_stack.pop_back();
+                break;
+
+            case OpCode::BINARY: {
+                Value right = pop();
+                Value left = pop();
+                auto op = static_cast<BinOp>(ins.arg);
+                if (op == BinOp::Unsupported) {
+                    // Бросит ошибку с текстом оператора
+                    push(binary_op(code->names[ins.arg2], left, right, ins.line));
+                    break;
+                }
+                push(binary_op(op, left, right, ins.line));
+                break;
+            }
+
+            case OpCode::UNARY: {
+                Value operand = pop();
+                push(unary_op(static_cast<UnOp>(ins.arg), operand, ins.line));
+                break;
+            }
+
+            case OpCode::LOAD_INDEX: {
+                Value index = pop();
+                Value container = pop();
+                push(get_index(container, index, ins.line));
+                break;
+            }
+
+            case OpCode::STORE_INDEX: {
+                ObjectPtr index = pop_value();
+                ObjectPtr container = pop_value();
+                ObjectPtr value = pop_value();
+                container->__setitem__(index, value);
+                break;
+            }
+
+            case OpCode::LOAD_ATTR: {
+                ObjectPtr obj = pop_value();
+                value_stack.push_back(get_attribute(obj, code->name_objs[ins.arg],
+                                                    code->attr_caches[ins.arg2], ins.line));
+                break;
+            }
+
+            case OpCode::STORE_ATTR: {
+                ObjectPtr obj = pop_value();
+                ObjectPtr value = pop_value();
+                set_attribute(obj, code->name_objs[ins.arg], std::move(value), code->attr_caches[ins.arg2], ins.line);
+                break;
+            }
+
+            case OpCode::BUILD_LIST: {
+                // Скаляры ложатся в буфер словами, без упаковки
+                auto first = value_stack.end() - ins.arg;
+                auto elems = make_ref<ListBuffer>();
+                elems->reserve(ins.arg);
+                for (auto it = first; it != value_stack.end(); ++it) {
+                    list_append(*elems, *it);
+                }
+                value_stack.erase(first, value_stack.end());
+                push_value(make_ref<PyList>(std::move(elems)));
+                break;
+            }
+
+            case OpCode::BUILD_DICT: {
+                // data() + смещение, а не &*first: при пустом литерале first == end()
+                auto first = value_stack.end() - 2 * ins.arg;
+                std::vector<ObjectPtr> keysAndValues = box_values(value_stack.data() + (value_stack.size() - 2 * ins.arg), 2 * ins.arg);
+                value_stack.erase(first, value_stack.end());
+                push_value(build_dict(keysAndValues, ins.line));
+                break;
+            }
+
+            case OpCode::BUILD_SET: {
+                auto first = value_stack.end() - ins.arg;
+                std::vector<ObjectPtr> elems = box_values(value_stack.data() + (value_stack.size() - ins.arg), ins.arg);
+                value_stack.erase(first, value_stack.end());
+                push_value(build_set(std::move(elems), ins.line));
+                break;
+            }
+
+            case OpCode::LIST_APPEND: {
+                // стек: ..., список, итератор, значение
+                Value value = pop();
+                auto *list = static_cast<PyList*>(value_stack[value_stack.size() - 2].ref().get());
+                if (value.is_object()) {
+                    list->gc_write_barrier(*value.ref());
+                }
+                list_append(list->buffer_for_write(), value);
+                break;
+            }
+
+            case OpCode::LIST_TO_TUPLE: {
+                ObjectPtr list = pop_value();
+                push_value(PyTuple::from(*static_cast<PyList&>(*list).buffer()));
+                break;
+            }
+
+            case OpCode::DICT_SET: {
+                // стек: ..., словарь, итератор, ключ, значение
+                ObjectPtr value = pop_value();
+                ObjectPtr key = pop_value();
+                const ObjectPtr &dict = value_stack[value_stack.size() - 2].ref();
+                try {
+                    dict->__setitem__(key, value);
+                }
+                catch (const RuntimeError &err) {
+                    throw RuntimeError(
+                        "Line " + std::to_string(ins.line)
+                        + " TypeError: " + err.what()
+                    );
+                }
+                break;
+            }
+
+            case OpCode::JUMP:
+                // Конец итерации цикла — безопасная точка для сборки циклов
+                GcHeap::collect_if_due();
+                pc = ins.arg;
+                break;
+
+            case OpCode::POP_JUMP_IF_FALSE: {
+                Value cond = pop();
+                if (!is_truthy(cond)) {
+                    pc = ins.arg;
+                }
+                break;
+            }
+
+            case OpCode::POP_JUMP_IF_TRUE: {
+                Value cond = pop();
+                if (is_truthy(cond)) {
+                    pc = ins.arg;
+                }
+                break;
+            }
+
+            case OpCode::GET_ITER: {
+                ObjectPtr iterable = pop_value();
+                auto iter = make_ref<PyIterator>();
+                if (auto list = kind_cast<PyList>(iterable)) {
+                    if (ins.arg) {
+                        iter->items = list->buffer();
+                    } else {
+                        iter->list = Ref<PyList>(list);
+                    }
+                } else if (auto tuple = kind_cast<PyTuple>(iterable)) {
+                    iter->tuple = Ref<PyTuple>(tuple);
+                } else if (auto str = kind_cast<PyString>(iterable)) {
+                    const std::string &s = str->get();
+                    iter->items = make_ref<ListBuffer>();
+                    iter->items->reserve(s.size());
+                    for (char c : s) {
+                        iter->items->push_back(py_char(c));
+                    }
+                } else {
+                    throw RuntimeError(
+                        "Line " + std::to_string(ins.line)
+                        + " TypeError: '" + deduceTypeName(iterable) + "' object is not iterable"
+                    );
+                }
+                push_value(std::move(iter));
+                break;
+            }
+
+            case OpCode::FOR_ITER: {
+                auto *iter = static_cast<PyIterator*>(value_stack.back().ref().get());
+                Value next = iter->next();
+                if (!next.empty()) {
+                    push(std::move(next));
+                } else {
+                    value_stack.pop_back();
+                    pc = ins.arg;
+                }
+                break;
+            }
+
+            case OpCode::UNPACK: {
+                // Элемент — кортеж (пары enumerate) или список той же длины
+                ObjectPtr element = pop_value();
+                auto tuple = kind_cast<PyTuple>(element);
+                auto inner = kind_cast<PyList>(element);
+                if (!tuple && !inner) {
+                    throw RuntimeError(
+                        "Line " + std::to_string(ins.line)
+                        + " TypeError: cannot unpack non-iterable element '"
+                        + element->repr() + "'"
+                    );
+                }
+                size_t count = tuple ? tuple->size() : inner->size();
+                if (count != static_cast<size_t>(ins.arg)) {
+                    throw RuntimeError(
+                        "Line " + std::to_string(ins.line)
+                        + " ValueError: not enough values to unpack (expected "
+                        + std::to_string(ins.arg) + ", got "
+                        + std::to_string(count) + ")"
+                    );
+                }
+                // Первое имя записывается первым — значит, его значение сверху
+                for (size_t i = count; i-- > 0;) {
+                    push(tuple ? Value(tuple->item(i)) : list_item(*inner->buffer(), i));
+                }
+                break;
+            }
+
+            case OpCode::TAIL_CALL:
+            case OpCode::CALL: {
+                // стек: ..., вызываемый, аргументы (ins.arg штук)
+                GcHeap::collect_if_due();
+                const size_t calleeAt = value_stack.size() - ins.arg - 1;
+                ObjectPtr callee = value_stack[calleeAt].object();
+
+                // Пользовательская функция — новый кадр, тот же цикл.
+                // Аргументы идут в локальные слоты прямо со стека, без упаковки.
+                if (auto *userFn = kind_cast<PyFunction>(callee)) {
+                    const CodeObject *body = userFn->getDecl()->code.get();
+                    if (!body) {
+                        std::vector<ObjectPtr> args = box_values(value_stack.data() + calleeAt + 1, ins.arg);
+                        value_stack.resize(calleeAt);
+                        push_value(call_function(*userFn, args, ins.line));
+                        break;
+                    }
+                    push_frame(*userFn, value_stack.data() + calleeAt + 1, ins.arg, ins.line);
+                    value_stack.resize(calleeAt);
+                    Frame *frame = &frames.back();
+                    if (ins.op == OpCode::TAIL_CALL && frames.size() > 1) {
+                        // return f(...): новый кадр занимает место текущего,
+                        // вместе с его адресом возврата и базой стека значений
+                        replace_caller_frame();
+                        frame = &frames.back();
+                        value_stack.resize(frame->stackBase);
+                    } else {
+                        frame->returnCode = code;
+                        frame->returnPc = pc;
+                        frame->stackBase = value_stack.size();
+                    }
+                    frame->callee = std::move(callee);
+                    code = body;
+                    pc = 0;
+                    base = frame->base;
+                    break;
+                }
+
+                // Класс: экземпляр создаём сами, а __init__ исполняем как обычный кадр,
+                // который вместо своего результата вернёт экземпляр (см. PyClass::__call__).
+                std::vector<ObjectPtr> args = box_values(value_stack.data() + calleeAt + 1, ins.arg);
+                value_stack.resize(calleeAt);
+
+                if (auto cls = kind_cast<PyClass>(callee)) {
+                    auto instance = PyInstance::create(Ref<PyClass>(cls));
+                    static const Ref<PyString> initName = py_intern("__init__");
+                    ObjectPtr initObj = cls->lookup(*initName);
+                    if (!initObj) {
+                        push_value(std::move(instance));
+                        break;
+                    }
+                    auto *initFn = kind_cast<PyFunction>(initObj);
+                    if (!initFn || !initFn->getDecl()->code) {
+                        // нестандартный __init__ — обычный путь через __call__
+                        try {
+                            push_value(callee->__call__(args));
+                        }
+                        catch (const RuntimeError &err) {
+                            throw RuntimeError(
+                                "Line " + std::to_string(ins.line)
+                                + " TypeError: " + err.what()
+                            );
+                        }
+                        break;
+                    }
+
+                    std::vector<Value> initArgs;
+                    initArgs.reserve(args.size() + 1);
+                    initArgs.emplace_back(instance);
+                    initArgs.insert(initArgs.end(), args.begin(), args.end());
+                    try {
+                        push_frame(*initFn, initArgs.data(), initArgs.size(), 0);
+                    }
+                    catch (const RuntimeError &err) {
+                        throw RuntimeError(
+                            "Line " + std::to_string(ins.line)
+                            + " TypeError: " + err.what()
+                        );
+                    }
+                    Frame &frame = frames.back();
+                    frame.callLine = ins.line;
+                    frame.returnCode = code;
+                    frame.returnPc = pc;
+                    frame.stackBase = value_stack.size();
+                    frame.initInstance = std::move(instance);
+                    frame.callee = std::move(initObj);
+                    code = initFn->getDecl()->code.get();
+                    pc = 0;
+                    base = frame.base;
+                    break;
+                }
+
+                // Встроенная функция
+                if (auto *builtinFn = kind_cast<PyBuiltinFunction>(callee)) {
+                    try {
+                        push_value(builtinFn->__call__(args));
+                    }
+                    catch (const RuntimeError &err) {
+                        throw RuntimeError(
+                            "Line " + std::to_string(ins.line)
+                            + " " + err.what()
+                        );
+                    }
+                    break;
+                }
+
+                // Любой другой объект — через __call__
+                try {
+                    push_value(callee->__call__(args));
+                }
+                catch (const RuntimeError &err) {
+                    throw RuntimeError(
+                        "Line " + std::to_string(ins.line)
+                        + " TypeError: " + err.what()
+                    );
+                }
+                break;
+            }
+
+            case OpCode::RETURN_VALUE: {
+                Value result = pop();
+                Frame &frame = frames.back();
+                value_stack.resize(frame.stackBase);
+                if (frame.initInstance) {
+                    result = frame.initInstance;
+                }
+                if (frames.size() == stopDepth) {
+                    return result;      // кадр входа снимет вызывающий (call_function)
+                }
+                return_to_caller(std::move(result));
+                break;
+            }
+
+            case OpCode::MAKE_FUNCTION: {
+                auto first = value_stack.end() - ins.arg2;
+                std::vector<ObjectPtr> defaults = box_values(value_stack.data() + (value_stack.size() - ins.arg2), ins.arg2);
+                value_stack.erase(first, value_stack.end());
+                push_value(make_function(*code->functions[ins.arg], std::move(defaults)));
+                break;
+            }
+
+            case OpCode::MAKE_CLASS:
+                push_value(make_class(*code->classes[ins.arg]));
+                break;
+
+            case OpCode::END_CLASS: {
+                auto *cls = static_cast<PyClass*>(value_stack.back().ref().get());
+                try {
+                    cls->seal_layout();
+                }
+                catch (const RuntimeError &err) {
+                    throw RuntimeError("Line " + std::to_string(ins.line) + ": " + err.what());
+                }
+                value_stack.pop_back();
+                break;
+            }
+
+            case OpCode::SET_CLASS_ATTR: {
+                ObjectPtr value = pop_value();
+                auto *cls = static_cast<PyClass*>(value_stack.back().ref().get());
+                cls->__setattr__(code->name_objs[ins.arg], value);
+                break;
+            }
+
+            case OpCode::PRINT:
+                if (ins.arg) {
+                    ObjectPtr value = pop_value();
+                    std::cout << value->repr() << std::endl;
+                } else {
+                    std::cout << std::endl;
+                }
+                break;
+
+            case OpCode::ASSERT_FAIL: {
+                ObjectPtr message = ins.arg ? pop_value() : nullptr;
+                raise_assertion(message, ins.line);
+            }
+
+            case OpCode::EXIT: {
+                ObjectPtr value = ins.arg ? pop_value() : nullptr;
+                exit_program(value);
+            }
+            }
+        }
+    }
+    catch (const RuntimeError &err) {
+        // Снимаем кадры, положенные этим циклом. Ошибка внутри __init__,
+        // вызванного через Class(...), оборачивается так же, как у обходчика
+        // AST, где её пробрасывает PyClass::__call__ и ловит visit(CallExpr).
+        std::string message = err.what();
+        while (frames.size() > stopDepth) {
+            if (frames.back().initInstance) {
+                message = "Line " + std::to_string(frames.back().callLine) + " TypeError: " + message;
+            }
+            pop_frame();
+        }
+        value_stack.resize(entryStack);
+        throw RuntimeError(message);
+    }
+    catch (...) {
+        while (frames.size() > stopDepth) {
+            pop_frame();
+        }
+        value_stack.resize(entryStack);
+        throw;
+    }
+
+    return Value{};
+}